@@ -0,0 +1,76 @@
+#ifndef ARRAY_H
+#define ARRAY_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "error.h"
+#include "gc.h"
+#include "token.h"
+#include "value.h"
+
+namespace cpplox
+{
+// A growable list of values stored contiguously, created with `[a, b, c]` or `Array(length)`.
+// Elements are read and written with `array[index]`, where the index must be an integer in bounds.
+// `array.push(value)` appends in amortized constant time, `array.pop()` removes the last element
+// and `array.length` is the number of elements.
+class Array : public Traceable
+{
+public:
+    Array() = default;
+    explicit Array(std::vector<Value> elements);
+
+    static std::shared_ptr<Array> create(std::vector<Value> elements);
+
+    [[nodiscard]] const Value& get(const Value& index, const Token& bracket) const;
+    void set(const Value& index, const Token& bracket, const Value& value);
+    inline void push(const Value& value)
+    {
+        m_elements.push_back(value);
+    }
+    Value pop(const Token& name);
+
+    [[nodiscard]] inline std::size_t length() const
+    {
+        return m_elements.size();
+    }
+    [[nodiscard]] inline const std::vector<Value>& elements() const
+    {
+        return m_elements;
+    }
+
+    // A fixed-length array can't be pushed to or popped from. The columns of a `RecordArray` are.
+    inline void fix_length()
+    {
+        m_fixed_length = true;
+    }
+    [[nodiscard]] inline bool fixed_length() const
+    {
+        return m_fixed_length;
+    }
+
+    // Number of arguments the method `name` takes, or -1 if arrays have no such method
+    [[nodiscard]] static int method_arity(std::string_view name);
+    // Returns `index` as a position in an array of `length` elements or reports why it isn't one
+    [[nodiscard]] static std::size_t position(const Value& index, std::size_t length, const Token& bracket);
+
+    [[nodiscard]] std::string to_string() const;
+
+    // Traceable
+    void trace(Tracer& tracer) const override;
+    void clear_references() override;
+
+private:
+    std::vector<Value> m_elements;
+    bool m_fixed_length = false;
+    // set while the elements are printed, so an array that contains itself prints as `[...]`
+    mutable bool m_printing = false;
+};
+
+}
+
+#endif  // ARRAY_H
@@ -14,35 +14,53 @@ using MethodsMap = std::unordered_map<std::string, std::shared_ptr<Function>>;
 class Class : public Callable, public Instance
 {
 public:
-    Class(const std::string& name, const std::optional<std::shared_ptr<Class>>& superclass, const MethodsMap& methods)
-        : m_name(name)
-        , m_super(superclass)
-        , m_methods(methods)
-    {
-    }
+    // `methods` are the class's own methods. Inherited methods are merged in here,
+    // so the class ends up with a flat method table.
+    // A record has `fields` instead: its instances are created with all of them, in a sealed shape,
+    // and the constructor takes their values in order.
+    Class(const std::string& name, const std::optional<std::shared_ptr<Class>>& superclass, const MethodsMap& methods,
+          const std::optional<std::vector<std::string>>& fields = std::nullopt);
 
     // Callable
     Value call(Interpreter* interpreter, const std::vector<Value>& args) override;
     [[nodiscard]] int arity() const override;
     [[nodiscard]] inline std::string to_string() const override
     {
-        return "<class " + m_name + ">";
+        return (is_record() ? "<record " : "<class ") + m_name + ">";
     }
     [[nodiscard]] std::optional<std::shared_ptr<Function>> find_method(const std::string& name) const;
+    // The shape every new instance of this class starts with
+    [[nodiscard]] inline const std::shared_ptr<Shape>& root_shape() const
+    {
+        return m_root_shape;
+    }
+    [[nodiscard]] inline bool is_record() const
+    {
+        return m_root_shape->sealed();
+    }
 
     // Instance
     Value get(const Token& name) override;
     void set(const Token& name, const Value& value) override;
 
+    // Traceable
+    void trace(Tracer& tracer) const override;
+    void clear_references() override;
+
     const std::string m_name;
-    const std::optional<std::shared_ptr<Class>> m_super;
+    std::optional<std::shared_ptr<Class>> m_super;
 
 private:
     // A bad idea and a violation of some OOP practises,
     // but I'll still go with it :)
     using Instance::to_string;
 
+    // own and inherited methods
     MethodsMap m_methods;
+    std::optional<std::shared_ptr<Function>> m_initializer;
+    // cached arity of `init` - 0 if there is no initializer
+    int m_arity = 0;
+    std::shared_ptr<Shape> m_root_shape;
 };
 
 }
@@ -5,41 +5,82 @@
 #include <unordered_map>
 
 #include "error.h"
+#include "gc.h"
 #include "value.h"
 
 namespace cpplox
 {
-class Environment
+// A scope. The global scope looks variables up by name, because globals aren't resolved.
+// Local scopes store their variables in slots - the resolver tells which slot a variable
+// lives in, so locals are never looked up by name.
+class Environment : public Traceable
 {
 public:
     // in this case m_enclosing remains uninitialized
     // and I will check for that later in get()
     Environment() = default;
 
-    // local block scope
-    explicit Environment(const std::shared_ptr<Environment>& enclosing)
-    {
-        m_enclosing = enclosing;
-    }
+    // local block scope with room for `size` variables
+    Environment(const std::shared_ptr<Environment>& enclosing, int size);
+    ~Environment();
+
+    Environment(const Environment&) = delete;
+    Environment& operator=(const Environment&) = delete;
+
+    // Allocates a local scope from the frame pool
+    static std::shared_ptr<Environment> create(const std::shared_ptr<Environment>& enclosing, int size);
 
-    void define(const std::string& name, const Value& val);
+    // Global scopes bind `name`, local scopes put the value in the next free slot.
+    // Returns the slot of the variable or -1 for globals.
+    int define(const std::string& name, const Value& val);
+    // Puts the value in the next free slot of a local scope and returns the slot
+    int define(const Value& val);
     Value get(const Token& name) const;
-    Value get_at(int distance, const std::string& name);
+    [[nodiscard]] inline const Value& get_at(int distance, int slot) const
+    {
+        return ancestor(distance)->m_slots[slot];
+    }
     void assign(const Token& name, const Value& val);
-    void assign_at(int distance, const Token& name, const Value& val);
-
-    [[nodiscard]] inline std::unordered_map<std::string, Value> get_values() const
+    // The variable itself, for code that reads and writes it directly, or nullptr for an undefined global.
+    // The pointer stays valid until the scope defines another variable.
+    Value* find(const std::string& name);
+    [[nodiscard]] inline Value* find_at(int distance, int slot) const
     {
-        return m_values;
+        return &ancestor(distance)->m_slots[slot];
+    }
+    inline void assign_at(int distance, int slot, const Value& val)
+    {
+        ancestor(distance)->m_slots[slot] = val;
     }
 
+    // Traceable
+    void trace(Tracer& tracer) const override;
+    void clear_references() override;
+
     // outer scope
     std::shared_ptr<Environment> m_enclosing;
 
 private:
-    std::shared_ptr<Environment> ancestor(int distance) const;
+    [[nodiscard]] inline Environment* ancestor(int distance) const
+    {
+        auto env = const_cast<Environment*>(this);
+        for (int i = 0; i < distance; i++)
+        {
+            env = env->m_enclosing.get();
+        }
 
+        return env;
+    }
+    // Makes room for at least `capacity` slots
+    void grow(int capacity);
+
+    // global variables
     std::unordered_map<std::string, Value> m_values;
+
+    // local variables
+    Value* m_slots = nullptr;
+    int m_size = 0;
+    int m_capacity = 0;
 };
 
 }
@@ -31,6 +31,21 @@ public:
     std::string m_msg;
 };
 
+// Thrown by native functions, which don't know where they were called from.
+// The interpreter reports it as a runtime error at the call.
+class NativeError : public std::exception
+{
+public:
+    explicit NativeError(std::string msg)
+        : m_msg(std::move(msg))
+    {
+    }
+
+    [[nodiscard]] const char* what() const noexcept override;
+
+    std::string m_msg;
+};
+
 namespace ReportError
 {
 static bool g_had_error = false;
@@ -0,0 +1,65 @@
+#ifndef FLOAT64_ARRAY_H
+#define FLOAT64_ARRAY_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "error.h"
+#include "token.h"
+#include "value.h"
+
+namespace cpplox
+{
+// A fixed-length array of numbers stored as plain doubles, created with `Float64Array(length)`
+// for zeros or `Float64Array(array)` to copy an array of numbers.
+// Elements are read and written with `array[index]` like in `Array`, and only numbers can be stored.
+//
+// The methods work on the whole array at once, in native loops that use SIMD instructions:
+//  - `a.add(b)`, `a.sub(b)`, `a.mul(b)` - a new array of the element-wise results
+//  - `a.scale(k)` - a new array of every element times `k`
+//  - `a.less(k)`, `a.greater(k)` - a new array of 1 where the comparison holds and 0 elsewhere
+//  - `a.sum()`, `a.dot(b)`, `a.min()`, `a.max()` - numbers, min and max are nil for an empty array
+//  - `a.prefix_sum()` - a new array of running totals
+//  - `a.to_array()` - the elements as an `Array`
+// See simd/kernels.h for how the sums are rounded.
+//
+// Since it holds no references, the collector never has to look inside one.
+class Float64Array
+{
+public:
+    explicit Float64Array(std::vector<double> elements);
+
+    static std::shared_ptr<Float64Array> create(std::vector<double> elements);
+
+    [[nodiscard]] Value get(const Value& index, const Token& bracket) const;
+    void set(const Value& index, const Token& bracket, const Value& value);
+
+    [[nodiscard]] inline std::size_t length() const
+    {
+        return m_elements.size();
+    }
+    [[nodiscard]] inline const std::vector<double>& elements() const
+    {
+        return m_elements;
+    }
+
+    // Number of arguments the method `name` takes, or -1 if typed arrays have no such method
+    [[nodiscard]] static int method_arity(std::string_view name);
+    // Runs the method `name` with as many arguments as `method_arity()` asks for
+    Value call_method(const Token& name, const Token& paren, const std::vector<Value>& args) const;
+
+    [[nodiscard]] std::string to_string() const;
+
+private:
+    // The argument of a method that takes another typed array of the same length
+    [[nodiscard]] const Float64Array& same_length(const Value& arg, const Token& paren) const;
+
+    std::vector<double> m_elements;
+};
+
+}
+
+#endif  // FLOAT64_ARRAY_H
@@ -0,0 +1,52 @@
+#ifndef FRAME_POOL_H
+#define FRAME_POOL_H
+
+#include <cstddef>
+
+namespace cpplox
+{
+// Allocator for environments, their variable slots and other short-lived runtime objects
+// like instances and bound methods.
+// Memory is carved out of large chunks by bumping a pointer, and freed blocks go to
+// a free list per size class. Calls allocate and release frames in LIFO order,
+// so a call almost always gets back the block the previous call just released.
+// Frames captured by closures simply stay allocated until the closure dies.
+class FramePool
+{
+public:
+    static void* allocate(std::size_t bytes);
+    static void deallocate(void* ptr, std::size_t bytes);
+};
+
+// Standard allocator interface on top of FramePool, used with `std::allocate_shared`
+template <typename T>
+class FrameAllocator
+{
+public:
+    using value_type = T;
+
+    FrameAllocator() = default;
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U>&)
+    {
+    }
+
+    T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(FramePool::allocate(n * sizeof(T)));
+    }
+    void deallocate(T* ptr, std::size_t n)
+    {
+        FramePool::deallocate(ptr, n * sizeof(T));
+    }
+
+    template <typename U>
+    friend bool operator==(const FrameAllocator&, const FrameAllocator<U>&)
+    {
+        return true;
+    }
+};
+
+}
+
+#endif  // FRAME_POOL_H
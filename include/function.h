@@ -7,8 +7,10 @@
 
 namespace cpplox
 {
+class Instance;
+
 // Represents a user-defined function
-class Function : public Callable
+class Function : public Callable, public Traceable
 {
 public:
     Function(const std::shared_ptr<ast::stmt::Function>& declaration, const std::shared_ptr<Environment>& closure,
@@ -21,6 +23,19 @@ public:
     }
 
     Value call(Interpreter* interpreter, const std::vector<Value>& args) override;
+    // Calls the method on `instance` as if it were bound to it,
+    // but without allocating a bound function.
+    Value call_method(Interpreter* interpreter, const std::shared_ptr<Instance>& instance,
+                      const std::vector<Value>& args);
+
+    // Creates the scope the body runs in. The caller defines the arguments in it
+    // and passes it to `run()`, which saves copying them through a vector.
+    [[nodiscard]] std::shared_ptr<Environment> new_frame() const;
+    // Same as `new_frame()`, but `this` refers to `instance`
+    [[nodiscard]] std::shared_ptr<Environment> new_method_frame(const std::shared_ptr<Instance>& instance) const;
+    // Runs the body in a frame made by `new_frame()` that has all arguments defined.
+    // Tail calls made by the body are run in a loop here, so they don't grow the stack.
+    Value run(Interpreter* interpreter, std::shared_ptr<Environment> frame);
 
     [[nodiscard]] inline int arity() const override
     {
@@ -34,6 +49,16 @@ public:
     // `this` represents the instance the function has been called on.
     std::shared_ptr<Function> bind(const std::shared_ptr<Instance>& instance);
 
+    // Traceable
+    inline void trace(Tracer& tracer) const override
+    {
+        tracer.edge(m_closure);
+    }
+    inline void clear_references() override
+    {
+        m_closure.reset();
+    }
+
     // Is this a static method on a class
     const bool m_is_static = false;
 
@@ -46,4 +71,4 @@ private:
 
 }
 
-#endif  // FUNCTION_H
\ No newline at end of file
+#endif  // FUNCTION_H
@@ -0,0 +1,84 @@
+#ifndef FUSER_H
+#define FUSER_H
+
+#include <optional>
+
+#include "interpreter.h"
+#include "syntax_tree/expression.h"
+#include "syntax_tree/statement.h"
+
+namespace cpplox
+{
+using namespace ast;
+
+// Replaces common patterns on the resolved AST with fused nodes that do their work in one visit:
+//  - `x = x op value` on a local becomes `UpdateLocal`
+//  - comparisons of locals and constants, like `i < n`, become `CompareLocals`,
+//    which `if` and `while` test directly
+//  - `object.field = object.field op value` becomes `UpdateField`
+// Runs after the resolver, because fused nodes need to know where their variables live.
+class Fuser : public stmt::Visitor, expr::Visitor
+{
+public:
+    explicit Fuser(Interpreter& interpreter)
+        : m_interpreter(interpreter)
+    {
+    }
+
+    // Fuses everything the interpreter is going to run
+    void run();
+
+    void visit(stmt::Block* stmt) override;
+    void visit(stmt::Var* stmt) override;
+    void visit(stmt::Function* stmt) override;
+    void visit(stmt::Expression* stmt) override;
+    void visit(stmt::If* stmt) override;
+    void visit(stmt::Print* stmt) override;
+    void visit(stmt::Return* stmt) override;
+    void visit(stmt::While* stmt) override;
+    void visit(stmt::Class* stmt) override;
+    void visit(stmt::Import* stmt) override;
+
+    Value visit(expr::Variable* expr) override;
+    Value visit(expr::Assign* expr) override;
+    Value visit(expr::Lambda* expr) override;
+    Value visit(expr::Binary* expr) override;
+    Value visit(expr::Call* expr) override;
+    Value visit(expr::Grouping* expr) override;
+    Value visit(expr::Literal* expr) override;
+    Value visit(expr::Logical* expr) override;
+    Value visit(expr::Unary* expr) override;
+    Value visit(expr::Get* expr) override;
+    Value visit(expr::Set* expr) override;
+    Value visit(expr::This* expr) override;
+    Value visit(expr::Super* expr) override;
+    Value visit(expr::Invoke* expr) override;
+    Value visit(expr::ArrayLiteral* expr) override;
+    Value visit(expr::Subscript* expr) override;
+    Value visit(expr::SetSubscript* expr) override;
+    Value visit(expr::UpdateLocal* expr) override;
+    Value visit(expr::CompareLocals* expr) override;
+    Value visit(expr::UpdateField* expr) override;
+
+private:
+    void fuse(stmt::Statement* stmt);
+    void fuse(const std::vector<StatementPtr>& stmts);
+    // Fuses the children of `expr` and then `expr` itself, replacing it if it matches a pattern
+    void fuse(ExpressionPtr& expr);
+
+    // Each returns nullptr if the expression doesn't match
+    ExpressionPtr fuse_update_local(const std::shared_ptr<expr::Assign>& assign);
+    ExpressionPtr fuse_compare(const std::shared_ptr<expr::Binary>& binary);
+    ExpressionPtr fuse_update_field(const std::shared_ptr<expr::Set>& set);
+
+    // A local variable or a literal, or nullopt for anything else
+    std::optional<expr::Operand> operand(const ExpressionPtr& expr);
+    // Whether both expressions read the same local variable or both are `this`
+    bool same_local(const ExpressionPtr& first, const ExpressionPtr& second);
+
+    Interpreter& m_interpreter;
+};
+
+}
+
+#endif  // FUSER_H
@@ -0,0 +1,201 @@
+#ifndef GC_H
+#define GC_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+#include "value.h"
+
+namespace cpplox
+{
+class Traceable;
+
+// Receives the references an object holds to other runtime objects
+class Tracer
+{
+public:
+    virtual ~Tracer() = default;
+
+    template <typename T>
+    void edge(const std::shared_ptr<T>& ptr)
+    {
+        if (ptr == nullptr)
+            return;
+
+        Traceable* target;
+        if constexpr (std::is_base_of_v<Traceable, T>)
+            target = ptr.get();
+        else
+        {
+            // native functions and other untracked objects are skipped
+            target = dynamic_cast<Traceable*>(ptr.get());
+            if (target == nullptr)
+                return;
+        }
+
+        if (visit(target, ptr.use_count()))
+            own(std::shared_ptr<Traceable>(ptr, target));
+    }
+    void edge(const Value& value);
+
+protected:
+    // Called for every reference. `use_count` is the number of owners of `object`.
+    // Returns whether the tracer wants an owning pointer to the object.
+    virtual bool visit(Traceable* object, long use_count) = 0;
+    virtual void own(std::shared_ptr<Traceable>)
+    {
+    }
+};
+
+// A runtime object that can be part of a reference cycle.
+// Every traceable object is registered with the garbage collector while it's alive.
+// Objects stay owned through `std::shared_ptr`: libstdc++ only uses atomic reference counts
+// once the process has started a thread, and the interpreter is single-threaded unless
+// read_csv() is asked to use more than one thread.
+class Traceable
+{
+public:
+    Traceable();
+    Traceable(const Traceable&);
+    // the list links belong to the object, not its value
+    inline Traceable& operator=(const Traceable&)
+    {
+        return *this;
+    }
+    virtual ~Traceable();
+
+    // Reports every `shared_ptr` the object holds to another runtime object.
+    // It must not report anything the object doesn't own.
+    virtual void trace(Tracer& tracer) const = 0;
+    // Drops all references to other objects. Called on garbage to break its cycles.
+    virtual void clear_references() = 0;
+
+private:
+    friend class GarbageCollector;
+
+    // intrusive list of the object's generation
+    Traceable* m_prev = nullptr;
+    Traceable* m_next = nullptr;
+
+    // survived a collection
+    bool m_old = false;
+
+    // collection state
+    bool m_marked = false;
+    long m_internal_refs = 0;
+    long m_use_count = -1;
+};
+
+// A generational tracing cycle collector on top of reference counting.
+// Refcounting frees most objects, but closures, bound methods and instances can form
+// cycles it never frees. The collector finds them like this:
+//  1. count the references every object gets from other tracked objects
+//  2. objects with more owners than that are referenced from outside the heap -
+//     interpreter frames, globals, the C++ stack - and are the roots
+//  3. mark everything reachable from the roots
+//  4. unmarked objects are only referenced by each other, so their references are dropped
+// Since roots are derived from the reference counts, a collection is safe at any point
+// where every tracked object is fully constructed.
+//
+// New objects go to the young generation, and objects that survive a collection are
+// promoted to the old one. A minor collection only looks at young objects: references
+// from old objects are counted as outside references, which makes the young objects
+// they point to roots. That's what a write barrier would record, so none is needed.
+// Old garbage is found by a major collection, which looks at both generations.
+//
+// A minor pause grows with the number of young objects, so the nursery shrinks when a pause
+// goes over `MINOR_PAUSE_BUDGET` and grows back when pauses are well under it.
+// Major collections stop the world for the whole heap: the roots come from reference counts
+// that change whenever the script runs, so a major can't be split into slices without
+// a write barrier on every store.
+class GarbageCollector
+{
+public:
+    // Whether the young generation is full
+    [[nodiscard]] static inline bool should_collect()
+    {
+        return s_young_count >= s_nursery_size;
+    }
+    // Runs a minor collection, or a major one if the old generation has grown enough
+    static void collect();
+
+    static void print_stats();
+
+private:
+    friend class Traceable;
+
+    class RefCounter;
+    class Marker;
+    class GarbageKeeper;
+
+    static inline void track(Traceable* object)
+    {
+        object->m_next = s_young;
+        if (s_young != nullptr)
+            s_young->m_prev = object;
+        s_young = object;
+
+        s_young_count++;
+    }
+    static inline void untrack(Traceable* object)
+    {
+        Traceable*& head = object->m_old ? s_old : s_young;
+        if (object->m_prev != nullptr)
+            object->m_prev->m_next = object->m_next;
+        else
+            head = object->m_next;
+        if (object->m_next != nullptr)
+            object->m_next->m_prev = object->m_prev;
+
+        // the live count only drops here, so the peak has to be taken before that
+        s_peak = std::max(s_peak, s_young_count + s_old_count);
+        if (object->m_old)
+            s_old_count--;
+        else
+            s_young_count--;
+    }
+
+    static void collect(bool major);
+    // Moves the surviving young objects to the old generation
+    static void promote();
+
+    // Halves the nursery after a minor pause over budget and doubles it after a short one
+    static void resize_nursery(std::chrono::nanoseconds pause);
+
+    // bounds of the number of objects allocated between two minor collections
+    static constexpr uint64_t MIN_NURSERY_SIZE = 256;
+    static constexpr uint64_t MAX_NURSERY_SIZE = 4096;
+    static constexpr std::chrono::microseconds MINOR_PAUSE_BUDGET{500};
+    // the old generation may grow to twice its live size before a major collection
+    static constexpr uint64_t MIN_MAJOR_THRESHOLD = 65536;
+
+    static inline Traceable* s_young = nullptr;
+    static inline Traceable* s_old = nullptr;
+    static inline uint64_t s_nursery_size = MAX_NURSERY_SIZE;
+    static inline uint64_t s_young_count = 0;
+    static inline uint64_t s_old_count = 0;
+    static inline uint64_t s_peak = 0;
+    static inline uint64_t s_major_threshold = MIN_MAJOR_THRESHOLD;
+};
+
+inline Traceable::Traceable()
+{
+    GarbageCollector::track(this);
+}
+
+inline Traceable::Traceable(const Traceable&)
+{
+    GarbageCollector::track(this);
+}
+
+inline Traceable::~Traceable()
+{
+    GarbageCollector::untrack(this);
+}
+
+}
+
+#endif  // GC_H
@@ -0,0 +1,88 @@
+#ifndef INLINE_CACHE_H
+#define INLINE_CACHE_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+
+#include "shape.h"
+
+namespace cpplox
+{
+class Function;
+
+// A per-site cache that remembers how a property was resolved for a given receiver shape.
+// Since every class has its own root shape, a shape also identifies the receiver's class,
+// so the cache can hold both field slots and methods.
+//
+// The syntax tree lives as long as the program, so the cache doesn't own what it remembers -
+// otherwise shapes and methods seen at a site would never be freed, and the collector would
+// count the cache as an outside owner. A hit needs a receiver of the entry's shape, and that
+// receiver keeps its class alive, which owns the shape's transitions and its methods.
+class InlineCache
+{
+public:
+    // What kind of site the cache belongs to. Only used for statistics.
+    enum class Kind
+    {
+        GET,
+        SET,
+        SUPER,
+        INVOKE,
+        // fused `object.field = object.field op value`
+        UPDATE
+    };
+    enum class State
+    {
+        UNINITIALIZED,
+        MONOMORPHIC,
+        POLYMORPHIC,
+        // Too many shapes were seen - the site stops caching
+        MEGAMORPHIC
+    };
+
+    struct Entry
+    {
+        std::weak_ptr<Shape> m_shape;
+        // The field's slot or -1 if the entry holds a method
+        int m_slot = -1;
+        // `Set` only: the shape the instance moves to when the field is new
+        std::weak_ptr<Shape> m_transition;
+        std::weak_ptr<Function> m_method;
+    };
+
+    explicit InlineCache(Kind kind)
+        : m_kind(kind)
+    {
+    }
+
+    // Returns the entry for `shape` or nullptr on a miss
+    const Entry* lookup(const Shape* shape);
+    // Remembers a resolved lookup. Moves the cache to the next state if needed.
+    void update(const std::shared_ptr<Shape>& shape, int slot, const std::shared_ptr<Shape>& transition,
+                const std::shared_ptr<Function>& method);
+
+    [[nodiscard]] inline State state() const
+    {
+        return m_state;
+    }
+
+    // Prints hit/miss counters of every site kind
+    static void print_stats();
+
+    // How many shapes a polymorphic site remembers before going megamorphic
+    static constexpr int MAX_ENTRIES = 4;
+
+private:
+    std::array<Entry, MAX_ENTRIES> m_entries;
+    // the shapes of the entries. A shape that was freed can leave its address to a new one,
+    // so a key only matches while the entry's shape is alive.
+    std::array<const Shape*, MAX_ENTRIES> m_keys{};
+    int m_size = 0;
+    State m_state = State::UNINITIALIZED;
+    Kind m_kind;
+};
+
+}
+
+#endif  // INLINE_CACHE_H
@@ -1,9 +1,13 @@
 #ifndef INSTANCE_H
 #define INSTANCE_H
 
-#include <unordered_map>
+#include <memory>
+#include <vector>
 
 #include "error.h"
+#include "frame_pool.h"
+#include "gc.h"
+#include "shape.h"
 #include "token.h"
 #include "value.h"
 
@@ -11,26 +15,49 @@ namespace cpplox
 {
 class Class;
 
-class Instance
+class Instance : public Traceable, public std::enable_shared_from_this<Instance>
 {
 public:
     virtual ~Instance() = default;
 
     // We need this constructor to not have to init Instance in Class constructor
     Instance() = default;
-    explicit Instance(const std::shared_ptr<Class>& klass)
-        : m_class(klass)
-    {
-    }
+    explicit Instance(const std::shared_ptr<Class>& klass);
 
     virtual Value get(const Token& name);
     virtual void set(const Token& name, const Value& value);
 
     [[nodiscard]] std::string to_string() const;
 
+    [[nodiscard]] inline const std::shared_ptr<Class>& klass() const
+    {
+        return m_class;
+    }
+    [[nodiscard]] inline const std::shared_ptr<Shape>& shape() const
+    {
+        return m_shape;
+    }
+    // Direct access to a field slot. The slot must come from this instance's shape.
+    [[nodiscard]] inline const Value& field(int slot) const
+    {
+        return m_fields[slot];
+    }
+    inline void set_field(int slot, const Value& value)
+    {
+        m_fields[slot] = value;
+    }
+    // Appends a new field. `shape` must be the transition of the current shape.
+    void add_field(const std::shared_ptr<Shape>& shape, const Value& value);
+
+    // Traceable
+    void trace(Tracer& tracer) const override;
+    void clear_references() override;
+
 private:
     std::shared_ptr<Class> m_class;
-    std::unordered_map<std::string, Value> m_fields;
+    std::shared_ptr<Shape> m_shape;
+    // field values indexed by the slots in `m_shape`
+    std::vector<Value, FrameAllocator<Value>> m_fields;
 };
 
 }
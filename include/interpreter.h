@@ -2,6 +2,7 @@
 #define INTERPRETER_H
 
 #include <deque>
+#include <string_view>
 #include <vector>
 
 #include "class.h"
@@ -10,15 +11,43 @@
 #include "fmt/core.h"
 #include "function.h"
 #include "lambda.h"
+#include "native_functions/array_fn.h"
 #include "native_functions/clock_fn.h"
+#include "native_functions/csv.h"
+#include "native_functions/files.h"
+#include "native_functions/float64_array_fn.h"
+#include "native_functions/flush_fn.h"
+#include "native_functions/json_fn.h"
+#include "native_functions/map_fn.h"
+#include "native_functions/memory_usage.h"
 #include "native_functions/println.h"
-#include "return.h"
+#include "native_functions/record_array_fn.h"
+#include "native_functions/string_builder_fn.h"
+#include "native_functions/strings.h"
 #include "syntax_tree/expression.h"
 
 namespace cpplox
 {
 using namespace ast;
 
+// Where a resolved local variable lives
+struct LocalSlot
+{
+    // how many scopes up the variable is
+    int depth;
+    // index of the variable in that scope
+    int slot;
+};
+
+// A call made by `return f(...)`. The returning function runs the callee
+// in its own loop instead of calling it recursively.
+struct TailCall
+{
+    std::shared_ptr<Function> function;
+    // the callee's scope with the arguments already defined
+    std::shared_ptr<Environment> frame;
+};
+
 // Interprets a syntax tree and executes it
 class Interpreter : public expr::Visitor, stmt::Visitor
 {
@@ -31,6 +60,16 @@ public:
 
     void interpret();
     void add_statements(const std::vector<StatementPtr>& new_statements);
+    // Defines the functions of the native module `name`. Returns false if there is no such module.
+    bool import_native_module(std::string_view name);
+
+    // Everything that's going to be interpreted, including imported modules
+    [[nodiscard]] inline std::deque<StatementPtr>& statements()
+    {
+        return m_to_interpret;
+    }
+    // Where the resolver put a local variable, or nullopt for globals
+    [[nodiscard]] std::optional<LocalSlot> local_slot(expr::Expression* expr) const;
 
     // expressions
     Value visit(expr::Literal* expr) override;
@@ -46,6 +85,13 @@ public:
     Value visit(expr::Set* expr) override;
     Value visit(expr::This* expr) override;
     Value visit(expr::Super* expr) override;
+    Value visit(expr::Invoke* expr) override;
+    Value visit(expr::ArrayLiteral* expr) override;
+    Value visit(expr::Subscript* expr) override;
+    Value visit(expr::SetSubscript* expr) override;
+    Value visit(expr::UpdateLocal* expr) override;
+    Value visit(expr::CompareLocals* expr) override;
+    Value visit(expr::UpdateField* expr) override;
 
     // statements
     void visit(stmt::Expression* stmt) override;
@@ -60,7 +106,20 @@ public:
     void visit(stmt::Import* stmt) override;
 
     void execute_block(const std::vector<StatementPtr>& statements, const std::shared_ptr<Environment>& env);
-    void resolve(expr::Expression* expr, int depth);
+    void resolve(expr::Expression* expr, int depth, int slot);
+
+    // Returns the value passed to `return` and clears the returning state.
+    // Functions call it after running their body.
+    Value take_return_value();
+    // Returns the tail call the returning function made, if any
+    std::optional<TailCall> take_tail_call();
+
+    // Makes every loop iteration from now on increment `counter`, which may be nullptr.
+    // Returns the previous counter.
+    inline uint32_t* count_loops_in(uint32_t* counter)
+    {
+        return std::exchange(m_loop_counter, counter);
+    }
 
     [[nodiscard]] inline std::shared_ptr<Environment> get_scope() const
     {
@@ -74,13 +133,27 @@ private:
     Value evaluate(expr::Expression* expr);
     void execute(stmt::Statement* stmt);
 
+    std::vector<Value> evaluate_args(const std::vector<ExpressionPtr>& args);
+    // Calls `callee` after checking that it's callable and takes `args.size()` arguments
+    Value call_value(const Value& callee, const Token& paren, const std::vector<Value>& args);
+    void check_arity(const Callable& callable, const Token& paren, const std::vector<Value>& args);
+    // Checks a call of a built-in object's method, where `arity` is -1 for an unknown method
+    void check_native_method(int arity, expr::Invoke* expr);
+
     Value lookup_variable(const Token& name, expr::Expression* expr);
     void check_null(const Value& value, const Token& name);
 
     void register_native_funcs();
 
+    // Applies a binary operator to evaluated operands
+    Value binary(expr::Binary* expr, const Value& left, const Value& right);
+    // Tests a fused comparison without making a `Value` when both operands are numbers
+    bool compare(expr::CompareLocals* expr);
+
     bool is_true(const Value& val);
     bool is_equal(const Value& val1, const Value& val2);
+    // Returns the string itself, or a new string with the value's text
+    std::shared_ptr<String> to_string_object(const Value& val);
 
     void check_number_operands(const Token& op, const Value& operand);
     void check_number_operands(const Token& op, const Value& left, const Value& right);
@@ -92,7 +165,17 @@ private:
     // resolution information
     // I used raw pointers here, because when looking up a variable,
     // the keys in this map are compared with a raw pointer to an expression
-    std::unordered_map<expr::Expression*, int> m_locals;
+    std::unordered_map<expr::Expression*, LocalSlot> m_locals;
+
+    // Set by a `return` statement. Blocks and loops stop executing
+    // until the function that is returning picks up the value.
+    bool m_returning = false;
+    Value m_return_value = std::nullopt;
+    // Set while evaluating the call of a `return f(...)`
+    bool m_tail_position = false;
+    std::optional<TailCall> m_tail_call;
+    // hotness of the function whose body is running, see `count_loops_in()`
+    uint32_t* m_loop_counter = nullptr;
 };
 
 }
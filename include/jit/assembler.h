@@ -0,0 +1,126 @@
+#ifndef JIT_ASSEMBLER_H
+#define JIT_ASSEMBLER_H
+
+#include <cstdint>
+#include <vector>
+
+namespace cpplox::jit
+{
+// General purpose registers, numbered as in the instruction encoding
+enum class Gp
+{
+    RAX = 0,
+    RCX,
+    RDX,
+    RBX,
+    RSP,
+    RBP,
+    RSI,
+    RDI
+};
+
+// The SSE registers the compiler uses
+enum class Xmm
+{
+    XMM0 = 0,
+    XMM1,
+    XMM2,
+    XMM3
+};
+
+// Conditions of `jcc`, as the low nibble of the opcode
+enum class Condition
+{
+    // unsigned conditions are the ones `ucomisd` sets
+    BELOW = 0x2,
+    ABOVE_EQUAL = 0x3,
+    EQUAL = 0x4,
+    NOT_EQUAL = 0x5,
+    BELOW_EQUAL = 0x6,
+    ABOVE = 0x7,
+    // the comparison was unordered - one of the operands was NaN
+    PARITY = 0xA
+};
+
+// `[base + disp]`
+struct Memory
+{
+    Gp base;
+    int32_t disp = 0;
+};
+
+// A position in the code that jumps can target before it's known
+struct Label
+{
+    int id;
+};
+
+// Encodes the handful of x86-64 instructions the JIT needs.
+// Every memory operand uses a 32-bit displacement and every jump a 32-bit offset,
+// which keeps the encoder simple at the cost of a few bytes.
+class Assembler
+{
+public:
+    void push(Gp reg);
+    void pop(Gp reg);
+    void ret();
+    // 64-bit `mov dst, src`
+    void mov(Gp dst, Gp src);
+    void mov(Gp dst, uint64_t imm);
+    // 32-bit `mov`, which zeroes the upper half
+    void mov32(Gp dst, int32_t imm);
+    void add(Gp dst, int32_t imm);
+    void sub(Gp dst, int32_t imm);
+
+    // moves the bits of a general purpose register to the low lane
+    void movq(Xmm dst, Gp src);
+    void movsd(Xmm dst, Memory src);
+    void movsd(Memory dst, Xmm src);
+    void movapd(Xmm dst, Xmm src);
+    void addsd(Xmm dst, Xmm src);
+    void subsd(Xmm dst, Xmm src);
+    void mulsd(Xmm dst, Xmm src);
+    void divsd(Xmm dst, Xmm src);
+    void xorpd(Xmm dst, Xmm src);
+    void ucomisd(Xmm left, Xmm right);
+
+    Label new_label();
+    // Makes `label` point at the next instruction
+    void bind(Label label);
+    void jmp(Label label);
+    void j(Condition condition, Label label);
+
+    // Returns the machine code with all jumps patched. Every used label must be bound.
+    [[nodiscard]] std::vector<uint8_t> finish();
+
+private:
+    void emit(uint8_t byte);
+    void emit32(uint32_t value);
+    void emit64(uint64_t value);
+    // REX prefix with W set for 64-bit operands
+    void rex_w(int reg, int rm);
+    // ModRM (and SIB) byte for a register operand
+    void modrm(int reg, int rm);
+    // ModRM (and SIB) bytes for a memory operand
+    void modrm(int reg, Memory memory);
+    // Two-operand SSE instruction with an optional mandatory prefix
+    void sse(uint8_t prefix, uint8_t opcode, Xmm dst, Xmm src);
+    // Emits a 32-bit placeholder that `finish()` replaces with the offset to `label`
+    void fixup(Label label);
+
+    struct Fixup
+    {
+        // where the offset goes
+        int position;
+        int label;
+    };
+
+    std::vector<uint8_t> m_code;
+    // offset of every label or -1 while it's unbound
+    std::vector<int> m_labels;
+    std::vector<Fixup> m_fixups;
+};
+
+}
+
+#endif  // JIT_ASSEMBLER_H
@@ -0,0 +1,106 @@
+#ifndef JIT_CODE_H
+#define JIT_CODE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cpplox::jit
+{
+// What compiled code returns
+enum class Status
+{
+    // the function returned the number stored in `result`
+    RETURNED_NUMBER = 0,
+    // the function returned `nil` - it ran off its end or used a bare `return;`.
+    // Compiled loops return it when they finish.
+    RETURNED_NIL = 1,
+    // the code hit a case it can't handle. Nothing it did is visible, so the interpreter
+    // runs the call again from the start, or the loop from the start of the iteration
+    DEOPTIMIZED = 2
+};
+
+// A variable from outside a compiled loop, which the loop reads and writes in its locals array
+struct Binding
+{
+    // where the variable lives - `m_depth` is how many scopes up from the loop it is,
+    // or -1 for globals, which are found by `m_name`
+    int m_depth = -1;
+    int m_slot = 0;
+    std::string m_name;
+    // where the loop keeps it
+    int m_local = 0;
+    // where the loop saves it at the start of every iteration, or -1 if the loop never assigns it
+    int m_saved = -1;
+};
+
+// Machine code of a compiled function or loop in executable memory.
+// The code is called with its locals, where the arguments or the loop's bindings are already stored.
+class Code
+{
+public:
+    using Entry = int (*)(double* locals, double* result);
+
+    // Copies `bytes` into a new mapping and makes it executable instead of writable.
+    // Returns nullptr if the memory can't be mapped.
+    static std::shared_ptr<Code> create(const std::vector<uint8_t>& bytes, int locals,
+                                        std::vector<Binding> bindings = {});
+
+    Code(void* memory, size_t size, int locals, std::vector<Binding> bindings)
+        : m_memory(memory)
+        , m_size(size)
+        , m_locals(locals)
+        , m_bindings(std::move(bindings))
+    {
+    }
+    ~Code();
+
+    Code(const Code&) = delete;
+    Code& operator=(const Code&) = delete;
+
+    [[nodiscard]] inline Status run(double* locals, double* result) const
+    {
+        return static_cast<Status>(reinterpret_cast<Entry>(m_memory)(locals, result));
+    }
+
+    // Number of locals the code uses, including the arguments
+    [[nodiscard]] inline int locals() const
+    {
+        return m_locals;
+    }
+    [[nodiscard]] inline size_t size() const
+    {
+        return m_size;
+    }
+    [[nodiscard]] inline const std::vector<Binding>& bindings() const
+    {
+        return m_bindings;
+    }
+
+    // guard failures and bailouts that sent a call back to the interpreter
+    uint32_t m_deopts = 0;
+
+private:
+    void* m_memory;
+    size_t m_size;
+    int m_locals;
+    // empty for functions
+    std::vector<Binding> m_bindings;
+};
+
+// Tiering state of a function or a loop
+struct Tier
+{
+    // calls and loop iterations the interpreter ran
+    uint32_t m_hotness = 0;
+    // the compiled code or nullptr
+    std::shared_ptr<Code> m_code;
+    // it can't be compiled, or its code was thrown away
+    bool m_not_compilable = false;
+};
+
+}
+
+#endif  // JIT_CODE_H
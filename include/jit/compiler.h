@@ -0,0 +1,137 @@
+#ifndef JIT_COMPILER_H
+#define JIT_COMPILER_H
+
+#include <memory>
+#include <vector>
+
+#include "interpreter.h"
+#include "jit/assembler.h"
+#include "jit/code.h"
+#include "syntax_tree/expression.h"
+#include "syntax_tree/statement.h"
+
+namespace cpplox::jit
+{
+using namespace ast;
+
+// Compiles the body of a function or a single loop to x86-64 code.
+// Only code that computes with numbers is supported: it may use parameters and locals,
+// number literals, arithmetic, comparisons in conditions, `and`/`or`/`!` in conditions,
+// assignments, `var` with an initializer, blocks, `if`, `while` and `return`.
+// Such code can't have side effects besides its own locals, and every value it makes is a number
+// as long as the arguments are numbers, which the caller checks before running the code.
+//
+// A loop is compiled while it runs, so it also uses variables from outside it, including globals.
+// They become bindings: the caller copies them into the locals array and back out when the loop ends.
+// Loops can't `return`.
+//
+// Locals live in an array of doubles passed in `rdi` and the result is stored through `rsi`.
+// Expressions are evaluated into `xmm0`, spilling the left operand of a binary operator
+// to the machine stack when the right one isn't a plain variable or literal.
+class Compiler : public stmt::Visitor, expr::Visitor
+{
+public:
+    explicit Compiler(const Interpreter& interpreter)
+        : m_interpreter(interpreter)
+    {
+    }
+
+    // Each returns nullptr if the code uses anything the compiler doesn't support
+    std::shared_ptr<Code> compile(stmt::Function* declaration);
+    std::shared_ptr<Code> compile(stmt::While* loop);
+
+    void visit(stmt::Block* stmt) override;
+    void visit(stmt::Var* stmt) override;
+    void visit(stmt::Function* stmt) override;
+    void visit(stmt::Expression* stmt) override;
+    void visit(stmt::If* stmt) override;
+    void visit(stmt::Print* stmt) override;
+    void visit(stmt::Return* stmt) override;
+    void visit(stmt::While* stmt) override;
+    void visit(stmt::Class* stmt) override;
+    void visit(stmt::Import* stmt) override;
+
+    // every expression leaves its value in xmm0
+    Value visit(expr::Variable* expr) override;
+    Value visit(expr::Assign* expr) override;
+    Value visit(expr::Lambda* expr) override;
+    Value visit(expr::Binary* expr) override;
+    Value visit(expr::Call* expr) override;
+    Value visit(expr::Grouping* expr) override;
+    Value visit(expr::Literal* expr) override;
+    Value visit(expr::Logical* expr) override;
+    Value visit(expr::Unary* expr) override;
+    Value visit(expr::Get* expr) override;
+    Value visit(expr::Set* expr) override;
+    Value visit(expr::This* expr) override;
+    Value visit(expr::Super* expr) override;
+    Value visit(expr::Invoke* expr) override;
+    Value visit(expr::ArrayLiteral* expr) override;
+    Value visit(expr::Subscript* expr) override;
+    Value visit(expr::SetSubscript* expr) override;
+    Value visit(expr::UpdateLocal* expr) override;
+    Value visit(expr::CompareLocals* expr) override;
+    Value visit(expr::UpdateField* expr) override;
+
+private:
+    // Thrown by the visitors when they meet something the compiler doesn't support
+    struct Unsupported
+    {
+    };
+
+    void begin();
+    // Emits the exit paths and copies the code to executable memory
+    std::shared_ptr<Code> finish();
+
+    void compile(const std::vector<StatementPtr>& stmts);
+    void compile(expr::Expression* expr);
+    // Saves the assigned bindings at the start of every iteration if `save` is set
+    void compile_loop(stmt::While* loop, bool save);
+    // Jumps to `target` if the truthiness of `expr` is `jump_if`, falls through otherwise
+    void branch(expr::Expression* expr, Label target, bool jump_if);
+    // Compares xmm0 with xmm1 by `op` and jumps like `branch()`
+    void branch_compare(const Token& op, Label target, bool jump_if);
+
+    // Loads a variable or a number literal into `reg` without touching other SSE registers.
+    // Returns false for any other expression.
+    bool load_simple(expr::Expression* expr, Xmm reg);
+    void load_constant(double value, Xmm reg);
+    void load_operand(const expr::Operand& operand, Xmm reg);
+    // Evaluates `right` into xmm1, keeping xmm0
+    void load_right(expr::Expression* right);
+    // xmm0 = xmm0 op xmm1
+    void arithmetic(const Token& op);
+
+    // Where a variable lives in the locals array
+    Memory local(expr::Expression* expr, const Token& name);
+    Memory local(int depth, int slot);
+    // Where a variable from outside a compiled loop lives in the locals array
+    Memory binding(int depth, int slot, const std::string& name);
+    // Stores xmm0 to a variable
+    void store(Memory target);
+    // Leaves the code with `status` in eax
+    void leave(Status status);
+
+    const Interpreter& m_interpreter;
+    // the loop being compiled, or nullptr for a function
+    stmt::While* m_loop = nullptr;
+    Assembler m_asm;
+
+    // where the first slot of every open scope is in the locals array
+    std::vector<int> m_scopes;
+    // variables defined so far in every open scope
+    std::vector<int> m_defined;
+    // size of the locals array
+    int m_locals = 0;
+    std::vector<Binding> m_bindings;
+
+    Label m_exit{};
+    Label m_deoptimize{};
+    // the code saving the bindings, which jumps back to `m_saved`
+    Label m_save{};
+    Label m_saved{};
+};
+
+}
+
+#endif  // JIT_COMPILER_H
@@ -0,0 +1,74 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "environment.h"
+#include "syntax_tree/statement.h"
+#include "value.h"
+
+namespace cpplox
+{
+class Interpreter;
+
+// Tiered execution of user functions, enabled by `--jit`.
+// Functions start out interpreted. Every call and every loop iteration in the body adds
+// to the function's hotness, and once it passes `HOT_THRESHOLD` the body is compiled
+// to machine code - see jit/compiler.h for what can be compiled.
+//
+// Compiled code is entered with a type guard: all arguments must be numbers.
+// When the guard fails, or the code bails out on a case it doesn't handle, the call is
+// deoptimized - the interpreter runs it from the start. That is always safe, because
+// compiled functions can't change anything besides their own locals.
+// A function that deoptimizes too often goes back to the interpreter for good.
+//
+// Loops are tiered the same way, but they can be entered while they run: once a loop has run enough
+// iterations in the interpreter, it is compiled and the rest of its iterations run as machine code.
+// The variables the loop uses are copied into compiled code and back out when it finishes.
+// If it bails out, the variables are restored to what they were at the start of the iteration,
+// and the interpreter continues from there.
+class Jit
+{
+public:
+    static inline void enable()
+    {
+        s_enabled = true;
+    }
+    [[nodiscard]] static inline bool enabled()
+    {
+        return s_enabled;
+    }
+
+    // Counts a call of `declaration` with the arguments in `frame` and runs its compiled code
+    // if there is any. Returns nullopt if the interpreter has to run the call.
+    static std::optional<Value> run(const Interpreter& interpreter, ast::stmt::Function* declaration,
+                                    const Environment& frame);
+    // Counts an iteration of `loop` running in `env` and runs the rest of the loop as compiled code
+    // if there is any. Returns whether the loop has finished.
+    static bool run_loop(const Interpreter& interpreter, ast::stmt::While* loop, Environment& env);
+
+    // Prints how many functions were compiled and how often compiled code ran
+    static void print_stats();
+
+    // calls plus loop iterations after which a function or a loop is compiled
+    static constexpr uint32_t HOT_THRESHOLD = 1000;
+    // deoptimizations after which compiled code is thrown away
+    static constexpr uint32_t MAX_DEOPTS = 100;
+
+private:
+    // Stores the code in `tier` or marks it as not compilable
+    static void compile(jit::Tier& tier, std::shared_ptr<jit::Code> code);
+    static void deoptimize(jit::Tier& tier);
+
+    static inline bool s_enabled = false;
+    // locals of the running compiled code. Compiled code never calls out, so one is enough.
+    static inline std::vector<double> s_locals;
+    // where the bindings of the running loop live
+    static inline std::vector<Value*> s_bindings;
+};
+
+}
+
+#endif  // JIT_H
@@ -0,0 +1,162 @@
+#ifndef JSON_H
+#define JSON_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "error.h"
+#include "token.h"
+#include "value.h"
+
+namespace cpplox
+{
+// A JSON text, parsed in two stages like simdjson does.
+// The first stage finds the structural characters - brackets, braces, colons, commas, the opening quote
+// of every string and the first character of every other value. It works on 64 bytes at a time with bit masks,
+// so the text is read once and without a branch per byte. See `index()` in json.cpp.
+// The second stage only walks those positions. It checks the grammar and matches up the brackets,
+// so any object or array can be skipped in one step. Values are converted to Lox values on demand.
+//
+// JSON objects become maps, arrays become arrays, and strings, numbers, booleans and null
+// become strings, numbers, booleans and nil. Strings without escapes share the buffer of the text.
+// Errors are `NativeError`s that say at which byte the text stops being JSON.
+class JsonDocument : public std::enable_shared_from_this<JsonDocument>
+{
+public:
+    explicit JsonDocument(std::shared_ptr<String> source);
+
+    // Parses `source` through both stages
+    static std::shared_ptr<JsonDocument> create(std::shared_ptr<String> source);
+
+    // The value that starts at structural `at`, converted completely
+    [[nodiscard]] Value materialize(std::size_t at) const;
+    // The value that starts at structural `at`, with objects and arrays as `LazyJson`
+    [[nodiscard]] Value lazy(std::size_t at) const;
+
+    // Whether the value at structural `at` is an object or an array
+    [[nodiscard]] inline bool is_object(std::size_t at) const
+    {
+        return m_text[m_positions[at]] == '{';
+    }
+    [[nodiscard]] inline bool is_array(std::size_t at) const
+    {
+        return m_text[m_positions[at]] == '[';
+    }
+    // The keys of the object or the elements of the array at structural `at`
+    [[nodiscard]] const std::vector<uint32_t>& members(std::size_t at) const;
+    // The string whose opening quote is structural `at`
+    [[nodiscard]] std::shared_ptr<String> string(std::size_t at) const;
+    // Same as `string()`, but equal keys without escapes share one string
+    [[nodiscard]] std::shared_ptr<String> key(std::size_t at) const;
+    // Whether the string at structural `at` is `key`, without converting it if it has no escapes
+    [[nodiscard]] bool key_equals(std::size_t at, std::string_view key) const;
+    // The text of the object or array at structural `at`
+    [[nodiscard]] std::string_view text(std::size_t at) const;
+
+    // objects and arrays can't be nested deeper than this
+    static constexpr std::size_t MAX_DEPTH = 1024;
+
+private:
+    // First stage
+    void index();
+    // Second stage
+    void match();
+
+    // A number, true, false or null
+    [[nodiscard]] Value scalar(std::size_t at) const;
+    // What `match()` says about a structural that follows the value at `at` where it shouldn't
+    [[nodiscard]] std::string expected_after_value(std::size_t at) const;
+    [[noreturn]] void fail(std::size_t position, const std::string& message) const;
+
+    std::shared_ptr<String> m_source;
+    std::string_view m_text;
+    // where the structural characters are
+    std::vector<uint32_t> m_positions;
+    // the structural that closes each object or array, and every other value's own structural
+    std::vector<uint32_t> m_ends;
+    // members of the objects and arrays that were looked into, by their opening structural
+    mutable std::unordered_map<uint32_t, std::vector<uint32_t>> m_members;
+    // the keys without escapes that were converted, by their text
+    mutable std::unordered_map<std::string_view, std::shared_ptr<String>> m_keys;
+};
+
+// A JSON object or array from `json_parse_lazy()` that hasn't been converted to Lox values.
+// `json[key]` and `json[index]` only convert the member they return, and nested objects and arrays
+// come back as more lazy values, so parts of the text that are never read are never converted.
+// `json.length` counts the members, `json.keys()` and `json.has(key)` work like they do for maps,
+// and `json.materialize()` converts the whole value like `json_parse()` does.
+// Unlike a map, an object with a key twice counts and lists that key twice.
+// Lazy values can't be changed. Printing one prints its JSON text.
+class LazyJson
+{
+public:
+    LazyJson(std::shared_ptr<const JsonDocument> document, std::size_t at);
+
+    static std::shared_ptr<LazyJson> create(std::shared_ptr<const JsonDocument> document, std::size_t at);
+
+    // The member of an object or the element of an array. Objects return nil for keys they don't have.
+    [[nodiscard]] Value get(const Value& index, const Token& bracket) const;
+
+    [[nodiscard]] inline std::size_t length() const
+    {
+        return m_document->members(m_at).size();
+    }
+    [[nodiscard]] inline std::string_view text() const
+    {
+        return m_document->text(m_at);
+    }
+
+    // Number of arguments the method `name` takes, or -1 if lazy values have no such method
+    [[nodiscard]] static int method_arity(std::string_view name);
+    // Runs the method `name` with as many arguments as `method_arity()` asks for
+    Value call_method(const Token& name, const Token& paren, const std::vector<Value>& args) const;
+
+    [[nodiscard]] std::string to_string() const;
+
+private:
+    // The value of `key` or nil
+    [[nodiscard]] Value find(std::string_view key) const;
+
+    std::shared_ptr<const JsonDocument> m_document;
+    // the structural of the opening bracket
+    std::size_t m_at;
+};
+
+// Writes Lox values as JSON. Maps become objects, arrays and typed arrays become arrays,
+// numbers that aren't finite become null, and lazy values are written as the text they came from.
+// Map keys that aren't strings are written as their text, like JavaScript does.
+class JsonWriter
+{
+public:
+    // Every `CHUNK_SIZE` bytes of text are passed to `sink` if there is one.
+    // Otherwise the writer keeps all of it.
+    explicit JsonWriter(void (*sink)(std::string_view) = nullptr);
+
+    void write(const Value& value);
+    // Passes the rest of the text to the sink
+    void finish();
+
+    [[nodiscard]] inline std::string& text()
+    {
+        return m_text;
+    }
+
+    static constexpr std::size_t CHUNK_SIZE = 16 * 1024;
+
+private:
+    void write(const Value& value, std::size_t depth);
+    void write_number(double number);
+    void write_string(std::string_view text);
+
+    void (*m_sink)(std::string_view);
+    std::string m_text;
+};
+
+}
+
+#endif  // JSON_H
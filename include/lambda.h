@@ -7,11 +7,12 @@
 
 namespace cpplox
 {
-class Lambda : public Callable
+class Lambda : public Callable, public Traceable
 {
 public:
-    explicit Lambda(const std::shared_ptr<ast::expr::Lambda>& declaration)
+    Lambda(const std::shared_ptr<ast::expr::Lambda>& declaration, const std::shared_ptr<Environment>& closure)
         : m_declaration(declaration)
+        , m_closure(closure)
     {
     }
 
@@ -25,10 +26,22 @@ public:
         return "<fn lambda>";
     }
 
+    // Traceable
+    inline void trace(Tracer& tracer) const override
+    {
+        tracer.edge(m_closure);
+    }
+    inline void clear_references() override
+    {
+        m_closure.reset();
+    }
+
 private:
     std::shared_ptr<ast::expr::Lambda> m_declaration;
+    // the scope the lambda was created in
+    std::shared_ptr<Environment> m_closure;
 };
 
 }
 
-#endif  // LAMBDA_H
\ No newline at end of file
+#endif  // LAMBDA_H
@@ -0,0 +1,107 @@
+#ifndef MAP_H
+#define MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "array.h"
+#include "error.h"
+#include "gc.h"
+#include "token.h"
+#include "value.h"
+
+namespace cpplox
+{
+// A hash map from strings, numbers and booleans to values, created with `Map()`.
+// `map[key]` reads a value, or nil if the key isn't there, and `map[key] = value` adds or replaces one.
+// `map.has(key)`, `map.delete(key)` and `map.size` work like their names say, and `map.keys()` and
+// `map.values()` return arrays to iterate over, in no particular order.
+//
+// The table uses open addressing with Robin Hood hashing: an entry that is further from its home
+// slot than the one it collides with takes that slot, and the other entry moves on. That keeps every
+// probe sequence short, so a lookup is one or two neighbouring entries in a flat array.
+// Entries keep their hash, so probing compares keys only when the hashes match,
+// and growing the table doesn't hash anything again.
+class Map : public Traceable
+{
+public:
+    static std::shared_ptr<Map> create();
+
+    // Returns the value of `key` or nil
+    [[nodiscard]] Value get(const Value& key, const Token& token) const;
+    void set(const Value& key, const Token& token, const Value& value);
+    [[nodiscard]] bool has(const Value& key, const Token& token) const;
+    // Returns whether the key was there
+    bool remove(const Value& key, const Token& token);
+
+    [[nodiscard]] inline std::size_t size() const
+    {
+        return m_size;
+    }
+    [[nodiscard]] std::shared_ptr<Array> keys() const;
+    [[nodiscard]] std::shared_ptr<Array> values() const;
+    // Calls `visit(key, value)` for every entry, in the same order as `keys()`
+    template <typename Visit>
+    void for_each(const Visit& visit) const
+    {
+        for (const Entry& entry : m_entries)
+        {
+            if (entry.m_distance != 0)
+                visit(entry.m_key, entry.m_value);
+        }
+    }
+
+    // Number of arguments the method `name` takes, or -1 if maps have no such method
+    [[nodiscard]] static int method_arity(std::string_view name);
+
+    [[nodiscard]] std::string to_string() const;
+
+    // The token for maps that native functions use. They only use keys that can't be bad, so it's never reported.
+    [[nodiscard]] static const Token& native_token();
+
+    // Traceable
+    void trace(Tracer& tracer) const override;
+    void clear_references() override;
+
+private:
+    struct Entry
+    {
+        Value m_key = std::nullopt;
+        Value m_value = std::nullopt;
+        std::size_t m_hash = 0;
+        // how far the entry is from its home slot, plus one. 0 marks an empty slot.
+        uint32_t m_distance = 0;
+    };
+
+    // Hash of a key, or a runtime error at `token` for values that can't be keys
+    [[nodiscard]] static std::size_t hash(const Value& key, const Token& token);
+    [[nodiscard]] static bool same_key(const Value& first, const Value& second);
+    // Slot of `key` or -1
+    [[nodiscard]] std::ptrdiff_t find(const Value& key, std::size_t hash) const;
+    void insert(Entry entry);
+    void grow();
+
+    [[nodiscard]] inline std::size_t home(std::size_t hash) const
+    {
+        return hash & (m_entries.size() - 1);
+    }
+
+    // the table is grown once it's 7/8 full
+    static constexpr std::size_t MAX_LOAD_NUMERATOR = 7;
+    static constexpr std::size_t MAX_LOAD_DENOMINATOR = 8;
+    static constexpr std::size_t MIN_CAPACITY = 8;
+
+    // the number of slots is always a power of two
+    std::vector<Entry> m_entries;
+    std::size_t m_size = 0;
+    // set while the entries are printed, so a map that contains itself prints as `{...}`
+    mutable bool m_printing = false;
+};
+
+}
+
+#endif  // MAP_H
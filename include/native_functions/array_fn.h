@@ -0,0 +1,24 @@
+#ifndef ARRAY_FN_H
+#define ARRAY_FN_H
+
+#include "callable.h"
+#include "value.h"
+
+namespace cpplox
+{
+/*
+ * Creates an array of 'length' nils.
+ *
+ * 'length': a non-negative integer
+ *
+ */
+class ArrayFunction : public Callable
+{
+public:
+    Value call(Interpreter* interpreter, const std::vector<Value>& args) override;
+    [[nodiscard]] int arity() const override;
+    [[nodiscard]] std::string to_string() const override;
+};
+}
+
+#endif  // ARRAY_FN_H
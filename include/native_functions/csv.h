@@ -0,0 +1,32 @@
+#ifndef CSV_FN_H
+#define CSV_FN_H
+
+#include "callable.h"
+#include "value.h"
+
+namespace cpplox
+{
+/*
+ * Reads the CSV file at 'path' and returns a map from column names to columns.
+ * A column where every cell is a number or empty is a Float64Array, with NaN for the empty cells.
+ * Any other column is an array of strings, where equal cells share one string.
+ * Cells can be quoted with '"', and '""' in a quoted cell is a quote. Blank lines are skipped.
+ *
+ * 'path': a string
+ * 'options': nil, or a map with any of
+ *      "delimiter" - a one-character string, "," by default
+ *      "header" - whether the first row names the columns, true by default.
+ *                 Without a header, the columns are numbered from 0.
+ *      "threads" - how many threads parse the file, 1 by default. No more are used than the CPU has.
+ *
+ */
+class ReadCsvFunction : public Callable
+{
+public:
+    Value call(Interpreter* interpreter, const std::vector<Value>& args) override;
+    [[nodiscard]] int arity() const override;
+    [[nodiscard]] std::string to_string() const override;
+};
+}
+
+#endif  // CSV_FN_H
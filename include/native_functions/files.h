@@ -0,0 +1,106 @@
+#ifndef FILES_FN_H
+#define FILES_FN_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "callable.h"
+#include "value.h"
+
+// Reading files. The files are mapped into memory, and the strings that come out of them
+// point straight into the mapping instead of copying the text.
+namespace cpplox
+{
+/*
+ * Returns the whole file at 'path' as a string.
+ *
+ * 'path': a string
+ *
+ */
+class ReadFileFunction : public Callable
+{
+public:
+    Value call(Interpreter* interpreter, const std::vector<Value>& args) override;
+    [[nodiscard]] int arity() const override;
+    [[nodiscard]] std::string to_string() const override;
+};
+
+/*
+ * Opens the file at 'path' for reading line by line and returns a line reader for next_line().
+ *
+ * 'path': a string
+ *
+ */
+class OpenLinesFunction : public Callable
+{
+public:
+    Value call(Interpreter* interpreter, const std::vector<Value>& args) override;
+    [[nodiscard]] int arity() const override;
+    [[nodiscard]] std::string to_string() const override;
+};
+
+/*
+ * Returns the next line of 'reader' without its line break, or nil after the last line.
+ *
+ * 'reader': a line reader from open_lines()
+ *
+ */
+class NextLineFunction : public Callable
+{
+public:
+    Value call(Interpreter* interpreter, const std::vector<Value>& args) override;
+    [[nodiscard]] int arity() const override;
+    [[nodiscard]] std::string to_string() const override;
+};
+
+// What open_lines() returns. Calling it is the same as passing it to next_line().
+// The file is mapped a window of `WINDOW_SIZE` bytes at a time, so files of any size can be read.
+// A window is unmapped once no line from it is alive anymore.
+// Files that report a size of 0, like the ones in /proc, are read whole into one window instead.
+class LineReader : public Callable
+{
+public:
+    LineReader(std::string path, int file, std::size_t size);
+    // reads the lines of `text`, which holds the whole file
+    LineReader(std::string path, std::shared_ptr<const char> text, std::size_t size);
+    ~LineReader() override;
+
+    LineReader(const LineReader&) = delete;
+    LineReader& operator=(const LineReader&) = delete;
+
+    // Returns the next line or nil
+    Value next();
+
+    Value call(Interpreter* interpreter, const std::vector<Value>& args) override;
+    [[nodiscard]] int arity() const override;
+    [[nodiscard]] std::string to_string() const override;
+
+    static constexpr std::size_t WINDOW_SIZE = 64 * 1024 * 1024;
+
+private:
+    // Maps at least `length` bytes of the file from `position` on, or up to the end of the file
+    void map(std::size_t position, std::size_t length);
+
+    std::string m_path;
+    // -1 when the whole file was read up front
+    int m_file;
+    std::size_t m_size;
+    // where the next line starts
+    std::size_t m_position = 0;
+
+    // the mapped part of the file is [m_window_start, m_window_end)
+    std::shared_ptr<const char> m_window;
+    std::size_t m_window_start = 0;
+    std::size_t m_window_end = 0;
+};
+
+// The string in `arg`, or an error that 'path' must be a string
+std::string path_argument(const Value& arg);
+// Maps the whole file at `path` and returns the text and its size. The text is nullptr for an empty file.
+// A file that reports a size of 0 is read instead, since it may still have contents.
+std::pair<std::shared_ptr<const char>, std::size_t> map_whole_file(const std::string& path);
+}
+
+#endif  // FILES_FN_H
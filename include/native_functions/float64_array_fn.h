@@ -0,0 +1,25 @@
+#ifndef FLOAT64_ARRAY_FN_H
+#define FLOAT64_ARRAY_FN_H
+
+#include "callable.h"
+#include "value.h"
+
+namespace cpplox
+{
+/*
+ * Creates a typed array of numbers.
+ *
+ * 'source': a non-negative integer for that many zeros,
+ *           or an array of numbers to copy
+ *
+ */
+class Float64ArrayFunction : public Callable
+{
+public:
+    Value call(Interpreter* interpreter, const std::vector<Value>& args) override;
+    [[nodiscard]] int arity() const override;
+    [[nodiscard]] std::string to_string() const override;
+};
+}
+
+#endif  // FLOAT64_ARRAY_FN_H
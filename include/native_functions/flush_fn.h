@@ -0,0 +1,22 @@
+#ifndef FLUSH_FN_H
+#define FLUSH_FN_H
+
+#include "callable.h"
+#include "value.h"
+
+namespace cpplox
+{
+/*
+ * Writes out everything print and println have buffered so far.
+ *
+ */
+class FlushFunction : public Callable
+{
+public:
+    Value call(Interpreter* interpreter, const std::vector<Value>& args) override;
+    [[nodiscard]] int arity() const override;
+    [[nodiscard]] std::string to_string() const override;
+};
+}
+
+#endif  // FLUSH_FN_H
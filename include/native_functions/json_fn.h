@@ -0,0 +1,72 @@
+#ifndef JSON_FN_H
+#define JSON_FN_H
+
+#include "callable.h"
+#include "value.h"
+
+namespace cpplox
+{
+/*
+ * Parses the JSON text 'text' into Lox values.
+ * Objects become maps, arrays become arrays, null becomes nil, and strings, numbers and booleans stay what they are.
+ * When an object has a key twice, the last value wins.
+ *
+ * 'text': a string
+ *
+ */
+class JsonParseFunction : public Callable
+{
+public:
+    Value call(Interpreter* interpreter, const std::vector<Value>& args) override;
+    [[nodiscard]] int arity() const override;
+    [[nodiscard]] std::string to_string() const override;
+};
+
+/*
+ * Checks that 'text' is JSON like 'json_parse()' does, but only converts values when they're read.
+ * Objects and arrays are returned as lazy values: 'json[key]', 'json[index]', 'json.length',
+ * 'json.keys()', 'json.has(key)' and 'json.materialize()' work on them, and they can't be changed.
+ * Strings and numbers are only checked when they're read.
+ *
+ * 'text': a string
+ *
+ */
+class JsonParseLazyFunction : public Callable
+{
+public:
+    Value call(Interpreter* interpreter, const std::vector<Value>& args) override;
+    [[nodiscard]] int arity() const override;
+    [[nodiscard]] std::string to_string() const override;
+};
+
+/*
+ * Returns 'value' written as JSON text, without any whitespace.
+ * Lazy values are written as the text they were parsed from.
+ *
+ * 'value': a map, array, Float64Array, string, number, boolean, nil or lazy JSON value
+ *
+ */
+class JsonStringifyFunction : public Callable
+{
+public:
+    Value call(Interpreter* interpreter, const std::vector<Value>& args) override;
+    [[nodiscard]] int arity() const override;
+    [[nodiscard]] std::string to_string() const override;
+};
+
+/*
+ * Prints 'value' as JSON text like 'json_stringify()' writes it, without building the whole string first.
+ *
+ * 'value': anything 'json_stringify()' takes
+ *
+ */
+class JsonWriteFunction : public Callable
+{
+public:
+    Value call(Interpreter* interpreter, const std::vector<Value>& args) override;
+    [[nodiscard]] int arity() const override;
+    [[nodiscard]] std::string to_string() const override;
+};
+}
+
+#endif  // JSON_FN_H
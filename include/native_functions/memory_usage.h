@@ -0,0 +1,22 @@
+#ifndef MEMORY_USAGE_FN_H
+#define MEMORY_USAGE_FN_H
+
+#include "callable.h"
+#include "value.h"
+
+namespace cpplox
+{
+/*
+ * Returns the resident set size of the interpreter in bytes.
+ * Useful for measuring how much memory a script uses.
+ */
+class MemoryUsageFunction : public Callable
+{
+public:
+    Value call(Interpreter* interpreter, const std::vector<Value>& args) override;
+    [[nodiscard]] int arity() const override;
+    [[nodiscard]] std::string to_string() const override;
+};
+}
+
+#endif  // MEMORY_USAGE_FN_H
@@ -0,0 +1,25 @@
+#ifndef RECORD_ARRAY_FN_H
+#define RECORD_ARRAY_FN_H
+
+#include "callable.h"
+#include "value.h"
+
+namespace cpplox
+{
+/*
+ * Creates a record array of 'length' rows whose fields are all nil.
+ *
+ * 'record': a record type
+ * 'length': a non-negative integer
+ *
+ */
+class RecordArrayFunction : public Callable
+{
+public:
+    Value call(Interpreter* interpreter, const std::vector<Value>& args) override;
+    [[nodiscard]] int arity() const override;
+    [[nodiscard]] std::string to_string() const override;
+};
+}
+
+#endif  // RECORD_ARRAY_FN_H
@@ -0,0 +1,21 @@
+#ifndef STRING_BUILDER_FN_H
+#define STRING_BUILDER_FN_H
+
+#include "callable.h"
+#include "value.h"
+
+namespace cpplox
+{
+/*
+ * Creates an empty string builder.
+ */
+class StringBuilderFunction : public Callable
+{
+public:
+    Value call(Interpreter* interpreter, const std::vector<Value>& args) override;
+    [[nodiscard]] int arity() const override;
+    [[nodiscard]] std::string to_string() const override;
+};
+}
+
+#endif  // STRING_BUILDER_FN_H
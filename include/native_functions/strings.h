@@ -0,0 +1,136 @@
+#ifndef STRINGS_FN_H
+#define STRINGS_FN_H
+
+#include "callable.h"
+#include "value.h"
+
+// The native module `strings`, loaded with `import strings;`.
+// Positions and lengths count bytes.
+namespace cpplox
+{
+/*
+ * Returns the position of the first 'pattern' in 'text', or -1 if there is none.
+ *
+ * 'text': a string to search
+ * 'pattern': a string to look for
+ *
+ */
+class FindFunction : public Callable
+{
+public:
+    Value call(Interpreter* interpreter, const std::vector<Value>& args) override;
+    [[nodiscard]] int arity() const override;
+    [[nodiscard]] std::string to_string() const override;
+};
+
+/*
+ * Returns whether 'pattern' is in 'text'.
+ *
+ * 'text': a string to search
+ * 'pattern': a string to look for
+ *
+ */
+class ContainsFunction : public Callable
+{
+public:
+    Value call(Interpreter* interpreter, const std::vector<Value>& args) override;
+    [[nodiscard]] int arity() const override;
+    [[nodiscard]] std::string to_string() const override;
+};
+
+/*
+ * Returns whether 'text' begins with 'prefix'.
+ *
+ * 'text': a string
+ * 'prefix': a string
+ *
+ */
+class StartsWithFunction : public Callable
+{
+public:
+    Value call(Interpreter* interpreter, const std::vector<Value>& args) override;
+    [[nodiscard]] int arity() const override;
+    [[nodiscard]] std::string to_string() const override;
+};
+
+/*
+ * Returns an array of the parts of 'text' between the 'separator's.
+ * The parts share the text's memory instead of copying it.
+ *
+ * 'text': a string to split
+ * 'separator': a non-empty string
+ *
+ */
+class SplitFunction : public Callable
+{
+public:
+    Value call(Interpreter* interpreter, const std::vector<Value>& args) override;
+    [[nodiscard]] int arity() const override;
+    [[nodiscard]] std::string to_string() const override;
+};
+
+/*
+ * Returns the elements of 'array' with 'separator' between them, as one string.
+ * Elements that aren't strings are written the way println writes them.
+ *
+ * 'array': an array
+ * 'separator': a string
+ *
+ */
+class JoinFunction : public Callable
+{
+public:
+    Value call(Interpreter* interpreter, const std::vector<Value>& args) override;
+    [[nodiscard]] int arity() const override;
+    [[nodiscard]] std::string to_string() const override;
+};
+
+/*
+ * Returns 'text' with every 'pattern' replaced by 'replacement'.
+ *
+ * 'text': a string
+ * 'pattern': a non-empty string to replace
+ * 'replacement': a string to put in its place
+ *
+ */
+class ReplaceFunction : public Callable
+{
+public:
+    Value call(Interpreter* interpreter, const std::vector<Value>& args) override;
+    [[nodiscard]] int arity() const override;
+    [[nodiscard]] std::string to_string() const override;
+};
+
+/*
+ * Returns 'length' bytes of 'text' from 'start' on, sharing the text's memory.
+ *
+ * 'text': a string
+ * 'start': a non-negative integer
+ * 'length': a non-negative integer. The substring must end inside the text.
+ *
+ */
+class SubstrFunction : public Callable
+{
+public:
+    Value call(Interpreter* interpreter, const std::vector<Value>& args) override;
+    [[nodiscard]] int arity() const override;
+    [[nodiscard]] std::string to_string() const override;
+};
+
+/*
+ * Returns the byte at 'index' in 'text' as a number from 0 to 255.
+ *
+ * 'text': a string
+ * 'index': a non-negative integer smaller than the text's length
+ *
+ */
+class CharCodeFunction : public Callable
+{
+public:
+    Value call(Interpreter* interpreter, const std::vector<Value>& args) override;
+    [[nodiscard]] int arity() const override;
+    [[nodiscard]] std::string to_string() const override;
+};
+}
+
+#endif  // STRINGS_FN_H
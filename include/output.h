@@ -0,0 +1,56 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <array>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+#include "value.h"
+
+namespace cpplox
+{
+// Where `print` and `println()` write. Text is collected in one large buffer and written out
+// in a single call when the buffer fills up, on `flush()` and when the interpreter exits.
+// With `Flush::LINE` every newline also writes the buffer out, which is the default on terminals,
+// so interactive output still shows up line by line.
+// Errors flush the buffer before they are reported, so they appear after the output that preceded them.
+class Output
+{
+public:
+    enum class Flush
+    {
+        // when a newline is written
+        LINE,
+        // only when the buffer is full or `flush()` is called
+        FULL,
+    };
+
+    // Sends the output to the file at `path` instead of stdout. Returns false if it can't be opened.
+    static bool open(const std::string& path);
+    static inline void set_flush(Flush policy)
+    {
+        s_flush = policy;
+    }
+    // Line buffering when the output is a terminal, full buffering otherwise
+    [[nodiscard]] static Flush default_flush();
+
+    static void write(std::string_view text);
+    // Writes the text of `value` without copying strings or allocating for numbers
+    static void write(const Value& value);
+    static void write_line(const Value& value);
+    static void flush();
+
+    static constexpr std::size_t BUFFER_SIZE = 64 * 1024;
+
+private:
+    static inline std::array<char, BUFFER_SIZE> s_buffer;
+    static inline std::size_t s_used = 0;
+    static inline std::FILE* s_file = stdout;
+    static inline Flush s_flush = Flush::FULL;
+};
+
+}
+
+#endif  // OUTPUT_H
@@ -46,6 +46,7 @@ private:
 
     StatementPtr declaration();
     StatementPtr class_declaration();
+    StatementPtr record_declaration();
     // `kind` represents the kind of declaration parsed -
     // a function or a method
     StatementPtr function(const std::string& kind);
@@ -0,0 +1,68 @@
+#ifndef RECORD_ARRAY_H
+#define RECORD_ARRAY_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "array.h"
+#include "class.h"
+#include "error.h"
+#include "gc.h"
+#include "token.h"
+#include "value.h"
+
+namespace cpplox
+{
+// Rows of one record type stored as columns, created with `RecordArray(Point, length)`
+// for `length` rows of nil fields.
+// Every field lives in its own array, so a loop over one field reads contiguous memory
+// instead of following a pointer to every record.
+//  - `rows[index]` - a new record with the fields of the row
+//  - `rows[index] = record` - copies the fields of a record of the same type into the row
+//  - `rows.push(record)` - appends a row
+//  - `rows.column("x")` - the array of field `x`, shared with `rows`, so writes to it change the rows.
+//    Columns can't be pushed to or popped from, since all of them must stay the same length.
+//  - `rows.length` - the number of rows
+class RecordArray : public Traceable
+{
+public:
+    RecordArray(const std::shared_ptr<Class>& record, std::size_t length);
+
+    static std::shared_ptr<RecordArray> create(const std::shared_ptr<Class>& record, std::size_t length);
+
+    [[nodiscard]] Value get(const Value& index, const Token& bracket) const;
+    void set(const Value& index, const Token& bracket, const Value& value);
+    void push(const Value& value, const Token& token);
+    [[nodiscard]] std::shared_ptr<Array> column(const Value& name, const Token& token) const;
+
+    [[nodiscard]] inline std::size_t length() const
+    {
+        return m_length;
+    }
+
+    // Number of arguments the method `name` takes, or -1 if record arrays have no such method
+    [[nodiscard]] static int method_arity(std::string_view name);
+
+    [[nodiscard]] std::string to_string() const;
+
+    // Traceable
+    void trace(Tracer& tracer) const override;
+    void clear_references() override;
+
+private:
+    // Returns the record that `value` holds or reports that it isn't one of this array's type
+    [[nodiscard]] const Instance& record(const Value& value, const Token& token) const;
+
+    std::shared_ptr<Class> m_record;
+    // one column per field, in slot order
+    std::vector<std::shared_ptr<Array>> m_columns;
+    // kept apart from the columns, since a record may have no fields
+    std::size_t m_length;
+};
+
+}
+
+#endif  // RECORD_ARRAY_H
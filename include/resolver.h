@@ -15,9 +15,16 @@ namespace cpplox
 {
 using namespace ast;
 
+struct LocalVariable
+{
+    // whether we have finished resolving the variable's initializer
+    bool is_ready = false;
+    // where the variable lives in its scope's environment
+    int slot = 0;
+};
+
 // strings are variable names
-// bools indicate whether we have finished resolving the variable's initializer
-using Scope = std::unordered_map<std::string, bool>;
+using Scope = std::unordered_map<std::string, LocalVariable>;
 
 // Resolves variable bindings (except global variables) and imports
 class Resolver : public stmt::Visitor, expr::Visitor
@@ -73,6 +80,14 @@ public:
     Value visit(expr::Set* expr) override;
     Value visit(expr::This* expr) override;
     Value visit(expr::Super* expr) override;
+    Value visit(expr::Invoke* expr) override;
+    Value visit(expr::ArrayLiteral* expr) override;
+    Value visit(expr::Subscript* expr) override;
+    Value visit(expr::SetSubscript* expr) override;
+    // fused nodes are created after resolving
+    Value visit(expr::UpdateLocal* expr) override;
+    Value visit(expr::CompareLocals* expr) override;
+    Value visit(expr::UpdateField* expr) override;
 
     void resolve(const std::vector<StatementPtr>& stmts);
 
@@ -0,0 +1,119 @@
+#ifndef SCALAR_REPLACEMENT_H
+#define SCALAR_REPLACEMENT_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "syntax_tree/expression.h"
+#include "syntax_tree/statement.h"
+
+namespace cpplox
+{
+using namespace ast;
+
+// Replaces instances that never leave the scope they are created in with their fields.
+// When `p` in `var p = Point(a, b);` is only ever used as `p.x` and `p.x = value`,
+// the declaration becomes
+//      Point;                          // still reports an undefined class
+//      var p#x = a;                    // the parameters of `init`
+//      var p#y = b;
+//      var p.x = <init's value of this.x>;
+//      var p.y = <init's value of this.y>;
+// and every `p.x` becomes the variable `p.x`, so the instance is never allocated.
+// The new names can't clash with user variables, because identifiers can't contain `.` or `#`.
+//
+// A class qualifies if it's declared once at the top level, never assigned to, has no superclass,
+// and its `init` only assigns fields of `this` from expressions that don't use `this`.
+// Records qualify the same way - their fields are the parameters.
+// Scripts that import modules are left alone, since a module could declare a class of the same name.
+// Runs before the resolver, which gives the new variables slots like any other local.
+class ScalarReplacer : public stmt::Visitor, expr::Visitor
+{
+public:
+    // Replaces what it can in the whole program
+    void run(std::vector<StatementPtr>& stmts);
+
+    void visit(stmt::Block* stmt) override;
+    void visit(stmt::Var* stmt) override;
+    void visit(stmt::Function* stmt) override;
+    void visit(stmt::Expression* stmt) override;
+    void visit(stmt::If* stmt) override;
+    void visit(stmt::Print* stmt) override;
+    void visit(stmt::Return* stmt) override;
+    void visit(stmt::While* stmt) override;
+    void visit(stmt::Class* stmt) override;
+    void visit(stmt::Import* stmt) override;
+
+    Value visit(expr::Variable* expr) override;
+    Value visit(expr::Assign* expr) override;
+    Value visit(expr::Lambda* expr) override;
+    Value visit(expr::Binary* expr) override;
+    Value visit(expr::Call* expr) override;
+    Value visit(expr::Grouping* expr) override;
+    Value visit(expr::Literal* expr) override;
+    Value visit(expr::Logical* expr) override;
+    Value visit(expr::Unary* expr) override;
+    Value visit(expr::Get* expr) override;
+    Value visit(expr::Set* expr) override;
+    Value visit(expr::This* expr) override;
+    Value visit(expr::Super* expr) override;
+    Value visit(expr::Invoke* expr) override;
+    Value visit(expr::ArrayLiteral* expr) override;
+    Value visit(expr::Subscript* expr) override;
+    Value visit(expr::SetSubscript* expr) override;
+    // fused nodes are created after this pass
+    Value visit(expr::UpdateLocal* expr) override;
+    Value visit(expr::CompareLocals* expr) override;
+    Value visit(expr::UpdateField* expr) override;
+
+    // Prints how many allocation sites were replaced
+    static void print_stats();
+
+private:
+    // An initializer that can be inlined at the call site
+    struct Inlinable
+    {
+        std::vector<std::string> m_params;
+        // `this.name = value` in the order `init` runs them
+        std::vector<std::pair<Token, ExpressionPtr>> m_fields;
+        std::unordered_set<std::string> m_field_names;
+        // variables other than the parameters the values use - they must mean the same at the call site
+        std::unordered_set<std::string> m_free_names;
+    };
+
+    // Finds the classes whose instances can be replaced
+    void find_inlinable(const std::vector<StatementPtr>& stmts);
+    std::optional<Inlinable> inlinable(stmt::Class* klass);
+
+    // Replaces the declarations in `stmts` that qualify and visits everything
+    void replace(std::vector<StatementPtr>& stmts);
+    // The statements that replace `stmts[index]` or an empty vector if it doesn't qualify
+    std::vector<StatementPtr> replacement(std::vector<StatementPtr>& stmts, int index);
+
+    // Whether `name` is a local variable where the pass is now
+    bool is_local(const std::string& name) const;
+    void declare(const std::string& name);
+    void visit(const ExpressionPtr& expr);
+    void visit_function(const std::vector<Token>& params, std::vector<StatementPtr>& body);
+
+    // set during the first walk, which only collects the names below
+    bool m_collecting = false;
+    bool m_has_imports = false;
+    std::unordered_set<std::string> m_assigned;
+    // classes declared at the top level
+    std::unordered_set<std::string> m_classes;
+    std::unordered_map<std::string, Inlinable> m_inlinable;
+    // names of the local variables of every open scope
+    std::vector<std::unordered_set<std::string>> m_scopes;
+
+    static inline uint64_t s_sites = 0;
+    static inline uint64_t s_replaced = 0;
+};
+
+}
+
+#endif  // SCALAR_REPLACEMENT_H
@@ -0,0 +1,45 @@
+#ifndef SHAPE_H
+#define SHAPE_H
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace cpplox
+{
+// Describes the layout of an instance's fields: which slot every field name lives in.
+// Instances that got the same fields added in the same order share one shape,
+// which lets inline caches remember a slot instead of hashing the field name.
+class Shape
+{
+public:
+    // Returns the slot of the field or -1 if the shape has no such field
+    [[nodiscard]] int lookup(const std::string& name) const;
+    // Returns the shape you get by appending `name` to this shape.
+    // Transitions are cached, so the same path always yields the same shape.
+    std::shared_ptr<Shape> with_field(const std::string& name);
+
+    [[nodiscard]] inline int size() const
+    {
+        return m_slots.size();
+    }
+
+    // A sealed shape can't get new fields. Records are created with one.
+    inline void seal()
+    {
+        m_sealed = true;
+    }
+    [[nodiscard]] inline bool sealed() const
+    {
+        return m_sealed;
+    }
+
+private:
+    bool m_sealed = false;
+    std::unordered_map<std::string, int> m_slots;
+    std::unordered_map<std::string, std::shared_ptr<Shape>> m_transitions;
+};
+
+}
+
+#endif  // SHAPE_H
@@ -0,0 +1,62 @@
+#ifndef SIMD_BLOCK_SEARCH_H
+#define SIMD_BLOCK_SEARCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "simd/search.h"
+
+// The substring search written once for any vector width. `B` wraps the instructions of one instruction set:
+//  - `Block` and `WIDTH` - the vector type and how many bytes it holds
+//  - `load` and `broadcast`
+//  - `equal(x, y)` - a bit mask with bit `i` set where byte `i` of `x` and `y` are equal
+//
+// Every file that includes this header compiles the search for its own instruction set,
+// so everything here has internal linkage.
+namespace cpplox::simd
+{
+namespace
+{
+template <typename B>
+struct BlockSearch
+{
+    using Block = typename B::Block;
+    static constexpr std::size_t WIDTH = B::WIDTH;
+
+    // Compares `WIDTH` start positions at once with the pattern's first and its last byte,
+    // and compares the whole pattern only where both match. Unlike skipping to the first byte
+    // with memchr, this rejects most positions even when the first byte is a common one.
+    static std::size_t find(std::string_view text, std::string_view pattern, std::size_t from)
+    {
+        const char* data = text.data();
+        std::size_t last = pattern.size() - 1;
+        // one past the last position a match can start at
+        std::size_t limit = text.size() - last;
+
+        Block first_bytes = B::broadcast(pattern[0]);
+        Block last_bytes = B::broadcast(pattern[last]);
+        std::size_t i = from;
+        for (; i + WIDTH <= limit; i += WIDTH)
+        {
+            std::uint32_t candidates =
+                B::equal(B::load(data + i), first_bytes) & B::equal(B::load(data + i + last), last_bytes);
+            while (candidates != 0)
+            {
+                std::size_t start = i + __builtin_ctz(candidates);
+                if (std::memcmp(data + start + 1, pattern.data() + 1, last) == 0)
+                    return start;
+                candidates &= candidates - 1;
+            }
+        }
+
+        // the last positions don't fill a block
+        return portable_find(text, pattern, i);
+    }
+};
+
+}
+}
+
+#endif  // SIMD_BLOCK_SEARCH_H
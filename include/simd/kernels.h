@@ -0,0 +1,53 @@
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#include <cstddef>
+
+namespace cpplox::simd
+{
+// Bulk kernels over arrays of doubles, used by `Float64Array`.
+// Every kernel has an AVX, an SSE2 and a portable version, and the best one the CPU supports
+// is picked the first time `kernels()` is called.
+//
+// All versions give bit-identical results. The element-wise kernels are exact anyway.
+// `sum` and `dot` add into 8 partial sums, element `i` going to sum `i % 8`, and combine them
+// in a fixed order, and `prefix_sum` adds blocks of 4 elements the way the AVX version does.
+// That is why their results can differ in the last bits from adding the elements one by one.
+// The one exception is `min` and `max` of an array with both 0 and -0, which may return either zero.
+struct Kernels
+{
+    // out[i] = a[i] op b[i]
+    void (*add)(const double* a, const double* b, double* out, std::size_t n);
+    void (*sub)(const double* a, const double* b, double* out, std::size_t n);
+    void (*mul)(const double* a, const double* b, double* out, std::size_t n);
+    // out[i] = a[i] * factor
+    void (*scale)(const double* a, double factor, double* out, std::size_t n);
+    // out[i] = a[i] op value ? 1 : 0
+    void (*less)(const double* a, double value, double* out, std::size_t n);
+    void (*greater)(const double* a, double value, double* out, std::size_t n);
+
+    double (*sum)(const double* a, std::size_t n);
+    double (*dot)(const double* a, const double* b, std::size_t n);
+    // Smallest and largest element of a non-empty array, or NaN if there is a NaN in it
+    double (*min)(const double* a, std::size_t n);
+    double (*max)(const double* a, std::size_t n);
+    // out[i] = a[0] + ... + a[i]
+    void (*prefix_sum)(const double* a, double* out, std::size_t n);
+
+    // instruction set the kernels use
+    const char* m_name;
+};
+
+// The kernels for this CPU
+const Kernels& kernels();
+
+// Each version lives in its own file, compiled for its instruction set
+const Kernels& portable_kernels();
+#if defined(__x86_64__)
+const Kernels& sse2_kernels();
+const Kernels& avx_kernels();
+#endif
+
+}
+
+#endif  // SIMD_KERNELS_H
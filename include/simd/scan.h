@@ -0,0 +1,28 @@
+#ifndef SIMD_SCAN_H
+#define SIMD_SCAN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace cpplox::simd
+{
+// Byte scanning for the parsers of text files.
+// On x86-64 these compare 16 bytes at a time with SSE2, which every x86-64 CPU has,
+// so unlike the kernels they don't need to pick a version at run time.
+
+// The first byte in [begin, end) that is `first` or `second`, or `end`
+const char* find_either(const char* begin, const char* end, char first, char second);
+// How many bytes in [begin, end) are `byte`
+std::size_t count(const char* begin, const char* end, char byte);
+
+// Bit masks of a block of 64 bytes, bit `i` for `block[i]`
+constexpr std::size_t BLOCK_SIZE = 64;
+// The bytes that are one of `bytes`
+std::uint64_t block_mask(const char* block, std::string_view bytes);
+// The control characters, bytes below 0x20
+std::uint64_t block_controls(const char* block);
+
+}
+
+#endif  // SIMD_SCAN_H
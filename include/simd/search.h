@@ -0,0 +1,26 @@
+#ifndef SIMD_SEARCH_H
+#define SIMD_SEARCH_H
+
+#include <cstddef>
+#include <string_view>
+
+namespace cpplox::simd
+{
+// Substring search for the strings module.
+// The search has an AVX2, an SSE2 and a portable version, and the best one the CPU supports
+// is picked the first time `find()` is called. All versions return the same positions.
+
+// Position of the first `pattern` in `text` at or after `from`, or npos. An empty pattern is found at `from`.
+std::size_t find(std::string_view text, std::string_view pattern, std::size_t from = 0);
+
+// The versions expect a non-empty pattern that fits in `text` after `from`.
+// Each vector version lives in its own file, compiled for its instruction set.
+std::size_t portable_find(std::string_view text, std::string_view pattern, std::size_t from);
+#if defined(__x86_64__)
+std::size_t sse2_find(std::string_view text, std::string_view pattern, std::size_t from);
+std::size_t avx2_find(std::string_view text, std::string_view pattern, std::size_t from);
+#endif
+
+}
+
+#endif  // SIMD_SEARCH_H
@@ -0,0 +1,230 @@
+#ifndef SIMD_VECTOR_KERNELS_H
+#define SIMD_VECTOR_KERNELS_H
+
+#include <cstddef>
+#include <limits>
+
+#include "simd/kernels.h"
+
+// The kernels written once for any vector width. `V` wraps the instructions of one instruction set:
+//  - `Vec` and `WIDTH` - the vector type and how many doubles it holds
+//  - `load`, `store`, `broadcast`, `zero`, and `load_one`, `store_one`, `to_double` for a single double
+//  - `add`, `sub`, `mul`
+//  - `min(x, acc)` and `max(x, acc)` - `x` if it's smaller (larger) than `acc`, otherwise `acc`
+//  - `less`, `greater` - 1 where the comparison holds and 0 elsewhere
+//  - `nan_mask`, `either`, `any` - find NaNs
+// The AVX version also has `shift_up(x, n)` and `last(x)` for `prefix_sum`.
+//
+// Every file that includes this header compiles the kernels for its own instruction set,
+// so everything here has internal linkage.
+namespace cpplox::simd
+{
+namespace
+{
+constexpr std::size_t PARTIAL_SUMS = 8;
+constexpr std::size_t PREFIX_BLOCK = 4;
+
+// Adds the partial sums in the same order in every version
+inline double combine(const double* partial)
+{
+    return ((partial[0] + partial[1]) + (partial[2] + partial[3])) +
+           ((partial[4] + partial[5]) + (partial[6] + partial[7]));
+}
+
+template <typename V>
+struct VectorKernels
+{
+    using Vec = typename V::Vec;
+    static constexpr std::size_t WIDTH = V::WIDTH;
+    static constexpr std::size_t ACCUMULATORS = PARTIAL_SUMS / WIDTH;
+
+    template <typename Op>
+    static inline void elementwise(const double* a, const double* b, double* out, std::size_t n, Op op)
+    {
+        std::size_t i = 0;
+        for (; i + WIDTH <= n; i += WIDTH)
+        {
+            V::store(out + i, op(V::load(a + i), V::load(b + i)));
+        }
+        for (; i < n; i++)
+        {
+            V::store_one(out + i, op(V::load_one(a + i), V::load_one(b + i)));
+        }
+    }
+
+    template <typename Op>
+    static inline void with_value(const double* a, double value, double* out, std::size_t n, Op op)
+    {
+        Vec wide = V::broadcast(value);
+        std::size_t i = 0;
+        for (; i + WIDTH <= n; i += WIDTH)
+        {
+            V::store(out + i, op(V::load(a + i), wide));
+        }
+        for (; i < n; i++)
+        {
+            V::store_one(out + i, op(V::load_one(a + i), wide));
+        }
+    }
+
+    static void add(const double* a, const double* b, double* out, std::size_t n)
+    {
+        elementwise(a, b, out, n, V::add);
+    }
+    static void sub(const double* a, const double* b, double* out, std::size_t n)
+    {
+        elementwise(a, b, out, n, V::sub);
+    }
+    static void mul(const double* a, const double* b, double* out, std::size_t n)
+    {
+        elementwise(a, b, out, n, V::mul);
+    }
+    static void scale(const double* a, double factor, double* out, std::size_t n)
+    {
+        with_value(a, factor, out, n, V::mul);
+    }
+    static void less(const double* a, double value, double* out, std::size_t n)
+    {
+        with_value(a, value, out, n, V::less);
+    }
+    static void greater(const double* a, double value, double* out, std::size_t n)
+    {
+        with_value(a, value, out, n, V::greater);
+    }
+
+    // Adds `a[i]` or `a[i] * b[i]` into partial sum `i % PARTIAL_SUMS`
+    template <bool PRODUCTS>
+    static inline double accumulate(const double* a, const double* b, std::size_t n)
+    {
+        Vec sums[ACCUMULATORS];
+        for (Vec& sum : sums)
+        {
+            sum = V::zero();
+        }
+
+        std::size_t i = 0;
+        for (; i + PARTIAL_SUMS <= n; i += PARTIAL_SUMS)
+        {
+            for (std::size_t k = 0; k < ACCUMULATORS; k++)
+            {
+                Vec value = V::load(a + i + k * WIDTH);
+                if constexpr (PRODUCTS)
+                    value = V::mul(value, V::load(b + i + k * WIDTH));
+                sums[k] = V::add(sums[k], value);
+            }
+        }
+
+        double partial[PARTIAL_SUMS];
+        for (std::size_t k = 0; k < ACCUMULATORS; k++)
+        {
+            V::store(partial + k * WIDTH, sums[k]);
+        }
+        for (; i < n; i++)
+        {
+            partial[i % PARTIAL_SUMS] += PRODUCTS ? a[i] * b[i] : a[i];
+        }
+
+        return combine(partial);
+    }
+
+    static double sum(const double* a, std::size_t n)
+    {
+        return accumulate<false>(a, nullptr, n);
+    }
+    static double dot(const double* a, const double* b, std::size_t n)
+    {
+        return accumulate<true>(a, b, n);
+    }
+
+    template <typename Op>
+    static inline double extreme(const double* a, std::size_t n, Op op)
+    {
+        Vec result = V::broadcast(a[0]);
+        Vec nans = V::nan_mask(result);
+        std::size_t i = 0;
+        for (; i + WIDTH <= n; i += WIDTH)
+        {
+            Vec x = V::load(a + i);
+            nans = V::either(nans, V::nan_mask(x));
+            result = op(x, result);
+        }
+
+        double lanes[WIDTH];
+        V::store(lanes, result);
+        double extreme = lanes[0];
+        for (std::size_t k = 1; k < WIDTH; k++)
+        {
+            extreme = V::to_double(op(V::broadcast(lanes[k]), V::broadcast(extreme)));
+        }
+        for (; i < n; i++)
+        {
+            nans = V::either(nans, V::nan_mask(V::broadcast(a[i])));
+            extreme = V::to_double(op(V::broadcast(a[i]), V::broadcast(extreme)));
+        }
+
+        return V::any(nans) ? std::numeric_limits<double>::quiet_NaN() : extreme;
+    }
+
+    static double min(const double* a, std::size_t n)
+    {
+        return extreme(a, n, V::min);
+    }
+    static double max(const double* a, std::size_t n)
+    {
+        return extreme(a, n, V::max);
+    }
+
+    static void prefix_sum(const double* a, double* out, std::size_t n)
+    {
+        double carry = 0;
+        std::size_t i = 0;
+        if constexpr (WIDTH == PREFIX_BLOCK)
+        {
+            // [a, b, c, d] -> [a, a + b, b + c, c + d] -> [a, a + b, (b + c) + a, (c + d) + (a + b)]
+            Vec wide_carry = V::zero();
+            for (; i + PREFIX_BLOCK <= n; i += PREFIX_BLOCK)
+            {
+                Vec x = V::load(a + i);
+                x = V::add(x, V::shift_up(x, 1));
+                x = V::add(x, V::shift_up(x, 2));
+                x = V::add(wide_carry, x);
+                V::store(out + i, x);
+                wide_carry = V::last(x);
+            }
+            carry = V::to_double(wide_carry);
+        }
+        else
+        {
+            // the same additions, one element at a time
+            for (; i + PREFIX_BLOCK <= n; i += PREFIX_BLOCK)
+            {
+                double first = a[i];
+                double second = a[i] + a[i + 1];
+                double third = (a[i + 1] + a[i + 2]) + a[i];
+                double fourth = (a[i + 2] + a[i + 3]) + second;
+                out[i] = carry + first;
+                out[i + 1] = carry + second;
+                out[i + 2] = carry + third;
+                out[i + 3] = carry + fourth;
+                carry = out[i + 3];
+            }
+        }
+
+        for (; i < n; i++)
+        {
+            carry += a[i];
+            out[i] = carry;
+        }
+    }
+
+    static const Kernels& get(const char* name)
+    {
+        static const Kernels kernels{add, sub, mul, scale, less, greater, sum, dot, min, max, prefix_sum, name};
+        return kernels;
+    }
+};
+
+}
+}
+
+#endif  // SIMD_VECTOR_KERNELS_H
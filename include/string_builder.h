@@ -0,0 +1,59 @@
+#ifndef STRING_BUILDER_H
+#define STRING_BUILDER_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "error.h"
+#include "token.h"
+#include "value.h"
+
+namespace cpplox
+{
+// A growable text buffer, created with `StringBuilder()`. Building text with `+` copies everything
+// built so far at every step, while appending to a builder only copies what is appended.
+//  - `b.append(value)` - appends the text `print` shows for `value`. Strings and numbers are
+//    written straight into the buffer.
+//  - `b.append_number(number, digits)` - appends `number` with exactly `digits` digits after the point
+//  - `b.clear()` - empties the buffer
+//  - `b.build()` - a string of the text so far. The builder keeps its text.
+//  - `b.length` - the length of the text in bytes
+// `append()`, `append_number()` and `clear()` return the builder, so calls can be chained.
+// Printing a builder prints its text.
+//
+// Since it holds no references, the collector never has to look inside one.
+class StringBuilder : public std::enable_shared_from_this<StringBuilder>
+{
+public:
+    static std::shared_ptr<StringBuilder> create();
+
+    void append(const Value& value);
+    void append_number(double number, int digits);
+
+    [[nodiscard]] inline std::size_t length() const
+    {
+        return m_text.size();
+    }
+    [[nodiscard]] inline std::string_view text() const
+    {
+        return m_text;
+    }
+
+    // Number of arguments the method `name` takes, or -1 if builders have no such method
+    [[nodiscard]] static int method_arity(std::string_view name);
+    // Runs the method `name` with as many arguments as `method_arity()` asks for
+    Value call_method(const Token& name, const Token& paren, const std::vector<Value>& args);
+
+    // the most digits `append_number()` writes after the point
+    static constexpr int MAX_DIGITS = 20;
+
+private:
+    std::string m_text;
+};
+
+}
+
+#endif  // STRING_BUILDER_H
@@ -0,0 +1,76 @@
+#ifndef STRING_OBJECT_H
+#define STRING_OBJECT_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace cpplox
+{
+// An immutable string value. Copying a `Value` only copies the pointer to it.
+// Concatenation creates a rope node that points to both halves instead of copying them,
+// so building a string piece by piece is linear. The rope is flattened into one buffer
+// the first time its text is needed. Slices share the buffer of the string they were taken from.
+// The buffer can be any memory that a shared pointer keeps alive, like a mapped file.
+class String
+{
+public:
+    // flat string
+    explicit String(std::string text);
+    // rope node
+    String(std::shared_ptr<String> left, std::shared_ptr<String> right);
+    // slice of a flat buffer
+    String(std::shared_ptr<const char> buffer, std::size_t offset, std::size_t length);
+    ~String();
+
+    String(const String&) = delete;
+    String& operator=(const String&) = delete;
+
+    static std::shared_ptr<String> create(std::string text);
+    // Returns the same object for equal texts. Used for literals, which live as long as the program.
+    static std::shared_ptr<String> intern(std::string_view text);
+    static std::shared_ptr<String> concat(const std::shared_ptr<String>& left, const std::shared_ptr<String>& right);
+    // Returns `length` characters from `start` on, sharing the buffer of `str`
+    static std::shared_ptr<String> slice(const std::shared_ptr<String>& str, std::size_t start, std::size_t length);
+    // Returns `length` characters of `buffer` from `start` on without copying them
+    static std::shared_ptr<String> borrow(std::shared_ptr<const char> buffer, std::size_t start, std::size_t length);
+
+    // The text of the string. Flattens ropes.
+    [[nodiscard]] std::string_view view() const;
+    [[nodiscard]] inline std::size_t length() const
+    {
+        return m_length;
+    }
+    // Computed once and cached
+    [[nodiscard]] std::size_t hash() const;
+    [[nodiscard]] bool equals(const String& other) const;
+
+    // concatenations shorter than this are copied instead of becoming ropes
+    static constexpr std::size_t MIN_ROPE_LENGTH = 64;
+
+private:
+    [[nodiscard]] inline bool is_rope() const
+    {
+        return m_buffer == nullptr;
+    }
+    void flatten() const;
+    // Drops a reference to a rope node without recursing into deep ropes
+    static void release(std::shared_ptr<String> node);
+
+    // The text lives in `m_buffer` at `m_offset`. Ropes have no buffer until they are flattened.
+    // The members are mutable because flattening doesn't change the text.
+    mutable std::shared_ptr<const char> m_buffer;
+    mutable std::size_t m_offset = 0;
+    std::size_t m_length = 0;
+
+    mutable std::shared_ptr<String> m_left;
+    mutable std::shared_ptr<String> m_right;
+
+    mutable std::size_t m_hash = 0;
+    mutable bool m_has_hash = false;
+};
+
+}
+
+#endif  // STRING_OBJECT_H
@@ -3,6 +3,7 @@
 
 #include <memory>
 
+#include "inline_cache.h"
 #include "token.h"
 
 namespace cpplox::ast::stmt
@@ -26,6 +27,13 @@ class Get;
 class Set;
 class This;
 class Super;
+class Invoke;
+class ArrayLiteral;
+class Subscript;
+class SetSubscript;
+class UpdateLocal;
+class CompareLocals;
+class UpdateField;
 
 // Interface that represents an operation executed on the given expressions
 class Visitor
@@ -44,6 +52,14 @@ public:
     virtual Value visit(Set* expr) = 0;
     virtual Value visit(This* expr) = 0;
     virtual Value visit(Super* expr) = 0;
+    virtual Value visit(Invoke* expr) = 0;
+    virtual Value visit(ArrayLiteral* expr) = 0;
+    virtual Value visit(Subscript* expr) = 0;
+    virtual Value visit(SetSubscript* expr) = 0;
+    // fused nodes - see fuser.h
+    virtual Value visit(UpdateLocal* expr) = 0;
+    virtual Value visit(CompareLocals* expr) = 0;
+    virtual Value visit(UpdateField* expr) = 0;
 
 protected:
     virtual ~Visitor() = default;
@@ -221,6 +237,8 @@ public:
 
     std::vector<Token> m_params;
     std::vector<std::shared_ptr<cpplox::ast::stmt::Statement>> m_body;
+    // Number of parameters and variables declared directly in the body. Set by the resolver.
+    int m_slots = 0;
 };
 
 class Get : public Expression
@@ -239,6 +257,7 @@ public:
 
     std::shared_ptr<Expression> m_object;
     Token m_name;
+    InlineCache m_cache{InlineCache::Kind::GET};
 };
 
 class Set : public Expression
@@ -259,6 +278,7 @@ public:
     std::shared_ptr<Expression> m_object;
     Token m_name;
     std::shared_ptr<Expression> m_value;
+    InlineCache m_cache{InlineCache::Kind::SET};
 };
 
 class This : public Expression
@@ -293,6 +313,184 @@ public:
 
     Token m_keyword;
     Token m_method;
+    InlineCache m_cache{InlineCache::Kind::SUPER};
+};
+
+// `object.name(args)` - a property lookup immediately followed by a call.
+// The parser creates it instead of Call(Get(...)), so a method can be called
+// without creating a bound method object.
+class Invoke : public Expression
+{
+public:
+    Invoke(const std::shared_ptr<Expression>& object, const Token& name, const Token& paren,
+           const std::vector<std::shared_ptr<Expression>>& args)
+        : m_object(object)
+        , m_name(name)
+        , m_paren(paren)
+        , m_args(args)
+    {
+    }
+
+    Value accept(Visitor* visitor) override
+    {
+        return visitor->visit(this);
+    }
+
+    std::shared_ptr<Expression> m_object;
+    Token m_name;
+    Token m_paren;
+    std::vector<std::shared_ptr<Expression>> m_args;
+    InlineCache m_cache{InlineCache::Kind::INVOKE};
+};
+
+// `[first, second, ...]`
+class ArrayLiteral : public Expression
+{
+public:
+    ArrayLiteral(const Token& bracket, const std::vector<std::shared_ptr<Expression>>& elements)
+        : m_bracket(bracket)
+        , m_elements(elements)
+    {
+    }
+
+    Value accept(Visitor* visitor) override
+    {
+        return visitor->visit(this);
+    }
+
+    Token m_bracket;
+    std::vector<std::shared_ptr<Expression>> m_elements;
+};
+
+// `object[index]`
+class Subscript : public Expression
+{
+public:
+    Subscript(const std::shared_ptr<Expression>& object, const Token& bracket, const std::shared_ptr<Expression>& index)
+        : m_object(object)
+        , m_bracket(bracket)
+        , m_index(index)
+    {
+    }
+
+    Value accept(Visitor* visitor) override
+    {
+        return visitor->visit(this);
+    }
+
+    std::shared_ptr<Expression> m_object;
+    Token m_bracket;
+    std::shared_ptr<Expression> m_index;
+};
+
+// `object[index] = value`
+class SetSubscript : public Expression
+{
+public:
+    SetSubscript(const std::shared_ptr<Expression>& object, const Token& bracket,
+                 const std::shared_ptr<Expression>& index, const std::shared_ptr<Expression>& value)
+        : m_object(object)
+        , m_bracket(bracket)
+        , m_index(index)
+        , m_value(value)
+    {
+    }
+
+    Value accept(Visitor* visitor) override
+    {
+        return visitor->visit(this);
+    }
+
+    std::shared_ptr<Expression> m_object;
+    Token m_bracket;
+    std::shared_ptr<Expression> m_index;
+    std::shared_ptr<Expression> m_value;
+};
+
+// The nodes below are created by the fusion pass from common patterns on the resolved AST.
+// They know where their variables live, so they don't visit child nodes to read them.
+// The original nodes are kept for the generic path and error messages.
+
+// A local variable or a constant read by a fused node
+struct Operand
+{
+    // where the variable lives - `m_depth` is -1 for constants
+    int m_depth = -1;
+    int m_slot = 0;
+    Value m_constant = std::nullopt;
+};
+
+// `x = x op value` on a local variable, like `i = i + 1` or `sum = sum + item`
+class UpdateLocal : public Expression
+{
+public:
+    UpdateLocal(const std::shared_ptr<Binary>& binary, int depth, int slot)
+        : m_binary(binary)
+        , m_depth(depth)
+        , m_slot(slot)
+    {
+    }
+
+    Value accept(Visitor* visitor) override
+    {
+        return visitor->visit(this);
+    }
+
+    // `x op value`
+    std::shared_ptr<Binary> m_binary;
+    int m_depth;
+    int m_slot;
+    // set when `value` is a literal, which is then never evaluated
+    std::optional<Value> m_constant;
+};
+
+// `a op b` comparing local variables or a local variable with a constant, like `i < n`.
+// Conditions of `if` and `while` that compare locals are tested without making a `Value`.
+class CompareLocals : public Expression
+{
+public:
+    CompareLocals(const std::shared_ptr<Binary>& binary, const Operand& left, const Operand& right)
+        : m_binary(binary)
+        , m_left(left)
+        , m_right(right)
+    {
+    }
+
+    Value accept(Visitor* visitor) override
+    {
+        return visitor->visit(this);
+    }
+
+    std::shared_ptr<Binary> m_binary;
+    Operand m_left;
+    Operand m_right;
+};
+
+// `object.field = object.field op value` where `object` is a local variable or `this`
+class UpdateField : public Expression
+{
+public:
+    UpdateField(const std::shared_ptr<Set>& set, const std::shared_ptr<Binary>& binary, int depth, int slot)
+        : m_set(set)
+        , m_binary(binary)
+        , m_depth(depth)
+        , m_slot(slot)
+    {
+    }
+
+    Value accept(Visitor* visitor) override
+    {
+        return visitor->visit(this);
+    }
+
+    // the original assignment, which handles everything but existing fields
+    std::shared_ptr<Set> m_set;
+    // `object.field op value`
+    std::shared_ptr<Binary> m_binary;
+    // where `object` lives
+    int m_depth;
+    int m_slot;
+    InlineCache m_cache{InlineCache::Kind::UPDATE};
 };
 
 }
@@ -2,6 +2,7 @@
 #define STATEMENT_H
 
 #include "expression.h"
+#include "jit/code.h"
 
 namespace cpplox::ast::stmt
 {
@@ -113,6 +114,8 @@ public:
     }
 
     std::vector<std::shared_ptr<Statement>> m_statements;
+    // Number of variables declared directly in this block. Set by the resolver.
+    int m_slots = 0;
 };
 
 class If : public Statement
@@ -134,6 +137,8 @@ public:
     ExpressionPtr m_condition;
     std::shared_ptr<Statement> m_then;
     std::optional<std::shared_ptr<Statement>> m_else;
+    // set by the fusion pass when the condition compares locals
+    expr::CompareLocals* m_fused_condition = nullptr;
 };
 
 class While : public Statement
@@ -152,6 +157,10 @@ public:
 
     ExpressionPtr m_condition;
     std::shared_ptr<Statement> m_stmt;
+    // set by the fusion pass when the condition compares locals
+    expr::CompareLocals* m_fused_condition = nullptr;
+    // JIT tiering state for entering the loop while it runs, see jit/jit.h
+    jit::Tier m_tier;
 };
 
 class Function : public Statement
@@ -176,6 +185,11 @@ public:
     std::vector<std::shared_ptr<Statement>> m_body;
     // Optional keywords that appear before function name
     std::vector<Token> m_prefix;
+    // Number of parameters and variables declared directly in the body. Set by the resolver.
+    int m_slots = 0;
+
+    // JIT tiering state, see jit/jit.h
+    jit::Tier m_tier;
 };
 
 class Return : public Statement
@@ -194,16 +208,22 @@ public:
 
     Token m_keyword;
     std::optional<ExpressionPtr> m_value;
+    // `return f(...)` - the callee can run in place of the returning function.
+    // Set by the resolver.
+    bool m_is_tail_call = false;
 };
 
+// Also used for `record Name { a, b }`, which has `m_fields` and no methods
 class Class : public Statement
 {
 public:
     Class(const Token& name, const std::optional<std::shared_ptr<expr::Variable>>& superclass,
-          const std::vector<std::shared_ptr<stmt::Function>>& methods)
+          const std::vector<std::shared_ptr<stmt::Function>>& methods,
+          const std::optional<std::vector<Token>>& fields = std::nullopt)
         : m_name(name)
         , m_super(superclass)
         , m_methods(methods)
+        , m_fields(fields)
     {
     }
 
@@ -215,6 +235,8 @@ public:
     Token m_name;
     std::optional<std::shared_ptr<expr::Variable>> m_super;
     std::vector<std::shared_ptr<stmt::Function>> m_methods;
+    // the fields of a record, nullopt for classes
+    std::optional<std::vector<Token>> m_fields;
 };
 
 class Import : public Statement
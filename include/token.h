@@ -16,6 +16,8 @@ enum class TokenType
     RIGHT_PAREN,
     LEFT_BRACE,
     RIGHT_BRACE,
+    LEFT_BRACKET,
+    RIGHT_BRACKET,
     COMMA,
     DOT,
     MINUS,
@@ -42,6 +44,7 @@ enum class TokenType
     // Keywords.
     AND,
     CLASS,
+    RECORD,
     ELSE,
     FALSE,
     FUN,
@@ -1,19 +1,34 @@
 #ifndef VALUE_H
 #define VALUE_H
 
+#include <array>
 #include <iostream>
 #include <memory>
 #include <optional>
+#include <string_view>
 #include <variant>
 
 #include "callable.h"
+#include "fmt/core.h"
+#include "string_object.h"
 
 namespace cpplox
 {
 class Instance;
+class Array;
+class Map;
+class Float64Array;
+class RecordArray;
+class LazyJson;
+class StringBuilder;
 
-using Val =
-    std::optional<std::variant<std::string, double, bool, std::shared_ptr<Callable>, std::shared_ptr<Instance>>>;
+// Big enough for any number `format_number()` writes
+using NumberBuffer = std::array<char, 64>;
+
+using Val = std::optional<std::variant<std::shared_ptr<String>, double, bool, std::shared_ptr<Callable>,
+                                       std::shared_ptr<Instance>, std::shared_ptr<Array>, std::shared_ptr<Map>,
+                                       std::shared_ptr<Float64Array>, std::shared_ptr<RecordArray>,
+                                       std::shared_ptr<LazyJson>, std::shared_ptr<StringBuilder>>>;
 
 class Value
 {
@@ -24,6 +39,10 @@ public:
     {
     }
     Value(const std::string& value)
+        : m_value(String::create(value))
+    {
+    }
+    Value(const std::shared_ptr<String>& value)
         : m_value(value)
     {
     }
@@ -43,17 +62,61 @@ public:
         : m_value(value)
     {
     }
+    Value(const std::shared_ptr<Array>& value)
+        : m_value(value)
+    {
+    }
+    Value(const std::shared_ptr<Map>& value)
+        : m_value(value)
+    {
+    }
+    Value(const std::shared_ptr<Float64Array>& value)
+        : m_value(value)
+    {
+    }
+    Value(const std::shared_ptr<RecordArray>& value)
+        : m_value(value)
+    {
+    }
+    Value(const std::shared_ptr<LazyJson>& value)
+        : m_value(value)
+    {
+    }
+    Value(const std::shared_ptr<StringBuilder>& value)
+        : m_value(value)
+    {
+    }
 
     // Prints the value
     friend std::ostream& operator<<(std::ostream& stream, const Value& val);
     [[nodiscard]] std::string to_string() const;
+    // Same text as `to_string()`, but strings aren't copied and numbers are formatted into `buffer`.
+    // The text of other values is stored in `storage`.
+    [[nodiscard]] std::string_view text(NumberBuffer& buffer, std::string& storage) const;
 
     Val m_value;
 };
 
-// Trims trailing zeroes from the end of the string
-std::string trim_zeroes(const std::string& str);
+// Writes the shortest text that reads back as the same number and returns it.
+// Numbers from 1e-7 up to 1e21 are written without an exponent.
+std::string_view format_number(double number, NumberBuffer& buffer);
+// Reads all of `text` as a number, in the syntax of std::from_chars, and returns whether it is one.
+// Short decimals like `-12.75` take a faster path that rounds the same.
+bool parse_number(std::string_view text, double& number);
 
 }
 
+// Lets values be printed with fmt::print
+template <>
+struct fmt::formatter<cpplox::Value> : fmt::formatter<std::string_view>
+{
+    template <typename FormatContext>
+    auto format(const cpplox::Value& value, FormatContext& ctx) const
+    {
+        cpplox::NumberBuffer buffer;
+        std::string storage;
+        return formatter<std::string_view>::format(value.text(buffer, storage), ctx);
+    }
+};
+
 #endif  // VALUE_H
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include "array.h"
+
+#include <cmath>
+
+#include "frame_pool.h"
+
+namespace cpplox
+{
+Array::Array(std::vector<Value> elements)
+    : m_elements(std::move(elements))
+{
+}
+
+std::shared_ptr<Array> Array::create(std::vector<Value> elements)
+{
+    return std::allocate_shared<Array>(FrameAllocator<Array>{}, std::move(elements));
+}
+
+const Value& Array::get(const Value& index, const Token& bracket) const
+{
+    return m_elements[position(index, m_elements.size(), bracket)];
+}
+
+void Array::set(const Value& index, const Token& bracket, const Value& value)
+{
+    m_elements[position(index, m_elements.size(), bracket)] = value;
+}
+
+Value Array::pop(const Token& name)
+{
+    if (m_elements.empty())
+        throw RuntimeError{name, "Can't pop from an empty array."};
+
+    Value last = std::move(m_elements.back());
+    m_elements.pop_back();
+    return last;
+}
+
+int Array::method_arity(std::string_view name)
+{
+    if (name == "push")
+        return 1;
+    if (name == "pop")
+        return 0;
+
+    return -1;
+}
+
+std::string Array::to_string() const
+{
+    if (m_printing)
+        return "[...]";
+
+    m_printing = true;
+    std::string result = "[";
+    NumberBuffer buffer;
+    std::string storage;
+    for (std::size_t i = 0; i < m_elements.size(); i++)
+    {
+        if (i != 0)
+            result += ", ";
+        result += m_elements[i].text(buffer, storage);
+    }
+    m_printing = false;
+
+    return result + "]";
+}
+
+void Array::trace(Tracer& tracer) const
+{
+    for (const Value& element : m_elements)
+    {
+        tracer.edge(element);
+    }
+}
+
+void Array::clear_references()
+{
+    m_elements.clear();
+}
+
+std::size_t Array::position(const Value& index, std::size_t length, const Token& bracket)
+{
+    if (!index.m_value.has_value() || !std::holds_alternative<double>(index.m_value.value()))
+        throw RuntimeError{bracket, "Array index must be a number."};
+
+    double number = std::get<double>(index.m_value.value());
+    if (number != std::trunc(number))
+        throw RuntimeError{bracket, "Array index must be an integer."};
+    if (number < 0 || number >= static_cast<double>(length))
+        throw RuntimeError{bracket, "Array index out of bounds."};
+
+    return static_cast<std::size_t>(number);
+}
+
+}
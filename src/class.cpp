@@ -5,14 +5,50 @@
 
 namespace cpplox
 {
+Class::Class(const std::string &name, const std::optional<std::shared_ptr<Class>> &superclass,
+             const MethodsMap &methods, const std::optional<std::vector<std::string>> &fields)
+    : m_name(name)
+    , m_super(superclass)
+    , m_methods(methods)
+    , m_root_shape(std::make_shared<Shape>())
+{
+    if (fields.has_value())
+    {
+        for (const std::string &field : fields.value())
+        {
+            m_root_shape = m_root_shape->with_field(field);
+        }
+        m_root_shape->seal();
+        m_arity = fields->size();
+    }
+
+    // the superclass's table is already flat, so one level of merging is enough.
+    // `insert` doesn't overwrite, so our own methods override the inherited ones
+    if (m_super.has_value())
+        m_methods.insert(m_super.value()->m_methods.begin(), m_super.value()->m_methods.end());
+
+    m_initializer = find_method("init");
+    if (m_initializer.has_value())
+        m_arity = m_initializer.value()->arity();
+}
+
 Value Class::call(Interpreter *interpreter, const std::vector<Value> &args)
 {
-    auto instance = std::make_shared<Instance>(std::make_shared<Class>(*this));
+    // every instance points back to this class object instead of owning a copy of it
+    auto instance = std::allocate_shared<Instance>(FrameAllocator<Instance>{},
+                                                   std::static_pointer_cast<Class>(shared_from_this()));
+    // the fields of a record are its constructor's arguments
+    if (is_record())
+    {
+        for (std::size_t slot = 0; slot < args.size(); slot++)
+        {
+            instance->set_field(slot, args[slot]);
+        }
+    }
     // constructor
-    std::optional<std::shared_ptr<Function>> initializer = find_method("init");
-    if (initializer.has_value())
+    else if (m_initializer.has_value())
     {
-        initializer.value()->bind(instance)->call(interpreter, args);
+        m_initializer.value()->call_method(interpreter, instance, args);
     }
 
     return instance;
@@ -20,21 +56,15 @@ Value Class::call(Interpreter *interpreter, const std::vector<Value> &args)
 
 int Class::arity() const
 {
-    std::optional<std::shared_ptr<Function>> initializer = find_method("init");
-    if (!initializer.has_value())
-        return 0;
-
-    return initializer.value()->arity();
+    return m_arity;
 }
 
 std::optional<std::shared_ptr<Function>> Class::find_method(const std::string &name) const
 {
-    if (m_methods.contains(name))
-        return m_methods.at(name);
+    auto method = m_methods.find(name);
+    if (method != m_methods.end())
+        return method->second;
 
-    if (m_super.has_value())
-        return m_super.value()->find_method(name);
-    
     return std::nullopt;
 }
 
@@ -45,8 +75,7 @@ Value Class::get(const Token &name)
     {
         if (method.value()->m_is_static)
         {
-            auto this_ptr = std::make_shared<Instance>(*this);
-            return std::dynamic_pointer_cast<Callable>(method.value()->bind(this_ptr));
+            return std::dynamic_pointer_cast<Callable>(method.value()->bind(shared_from_this()));
         }
         else
             throw RuntimeError{name, "Only static methods can be called from a class."};
@@ -60,4 +89,25 @@ void Class::set(const Token &name, const Value &value)
     throw RuntimeError{name, "Can't set properties on a class."};
 }
 
+void Class::trace(Tracer &tracer) const
+{
+    Instance::trace(tracer);
+    if (m_super.has_value())
+        tracer.edge(m_super.value());
+    for (const auto &[name, method] : m_methods)
+    {
+        tracer.edge(method);
+    }
+    if (m_initializer.has_value())
+        tracer.edge(m_initializer.value());
+}
+
+void Class::clear_references()
+{
+    Instance::clear_references();
+    m_super.reset();
+    m_methods.clear();
+    m_initializer.reset();
+}
+
 }
@@ -1,13 +1,52 @@
 #include "environment.h"
 
+#include <algorithm>
+
+#include "frame_pool.h"
+
 namespace cpplox
 {
-void Environment::define(const std::string &name, const Value &val)
+Environment::Environment(const std::shared_ptr<Environment> &enclosing, int size)
+    : m_enclosing(enclosing)
 {
-    // erase the previous value
-    if (m_values.contains(name)) m_values.erase(name);
+    grow(size);
+}
 
-    m_values.insert({name, val});
+Environment::~Environment()
+{
+    if (m_slots == nullptr)
+        return;
+
+    std::destroy_n(m_slots, m_size);
+    FramePool::deallocate(m_slots, m_capacity * sizeof(Value));
+}
+
+std::shared_ptr<Environment> Environment::create(const std::shared_ptr<Environment> &enclosing, int size)
+{
+    return std::allocate_shared<Environment>(FrameAllocator<Environment>{}, enclosing, size);
+}
+
+int Environment::define(const std::string &name, const Value &val)
+{
+    if (m_enclosing == nullptr)
+    {
+        // erase the previous value
+        m_values.insert_or_assign(name, val);
+        return -1;
+    }
+
+    return define(val);
+}
+
+int Environment::define(const Value &val)
+{
+    // the resolver presizes the scope, so this only happens
+    // for scopes it didn't count the variables for
+    if (m_size == m_capacity)
+        grow(m_capacity == 0 ? 4 : m_capacity * 2);
+
+    std::construct_at(m_slots + m_size, val);
+    return m_size++;
 }
 
 Value Environment::get(const Token &name) const
@@ -23,9 +62,16 @@ Value Environment::get(const Token &name) const
     throw RuntimeError{name, "Undefined variable '" + name.lexeme() + "'."};
 }
 
-Value Environment::get_at(int distance, const std::string &name)
+Value *Environment::find(const std::string &name)
 {
-    return ancestor(distance)->m_values.at(name);
+    auto element = m_values.find(name);
+    if (element != m_values.end())
+        return &element->second;
+
+    if (m_enclosing != nullptr)
+        return m_enclosing->find(name);
+
+    return nullptr;
 }
 
 void Environment::assign(const Token &name, const Value &val)
@@ -47,20 +93,41 @@ void Environment::assign(const Token &name, const Value &val)
     throw RuntimeError{name, "Undefined variable '" + name.lexeme() + "'."};
 }
 
-void Environment::assign_at(int distance, const Token &name, const Value &val)
+void Environment::trace(Tracer &tracer) const
+{
+    tracer.edge(m_enclosing);
+    for (int i = 0; i < m_size; i++)
+    {
+        tracer.edge(m_slots[i]);
+    }
+    for (const auto &[name, value] : m_values)
+    {
+        tracer.edge(value);
+    }
+}
+
+void Environment::clear_references()
 {
-    ancestor(distance)->m_values.at(name.lexeme()) = val;
+    m_enclosing.reset();
+    std::fill_n(m_slots, m_size, Value{std::nullopt});
+    m_values.clear();
 }
 
-std::shared_ptr<Environment> Environment::ancestor(int distance) const
+void Environment::grow(int capacity)
 {
-    auto env = std::make_shared<Environment>(*this);
-    for (int i = 0; i < distance; i++)
+    if (capacity <= m_capacity)
+        return;
+
+    auto slots = static_cast<Value *>(FramePool::allocate(capacity * sizeof(Value)));
+    if (m_slots != nullptr)
     {
-        env = env->m_enclosing;
+        std::uninitialized_move_n(m_slots, m_size, slots);
+        std::destroy_n(m_slots, m_size);
+        FramePool::deallocate(m_slots, m_capacity * sizeof(Value));
     }
 
-    return env;
+    m_slots = slots;
+    m_capacity = capacity;
 }
 
-}
\ No newline at end of file
+}
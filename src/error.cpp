@@ -1,5 +1,7 @@
 #include "error.h"
 
+#include "output.h"
+
 namespace cpplox
 {
 const char* ParseError::what() const noexcept
@@ -12,6 +14,11 @@ const char* RuntimeError::what() const noexcept
     return m_msg.c_str();
 }
 
+const char* NativeError::what() const noexcept
+{
+    return m_msg.c_str();
+}
+
 namespace ReportError
 {
 void error(const Token& token, std::string_view msg)
@@ -37,6 +44,7 @@ void runtime_error(const RuntimeError& run_error)
 
 void debug_error(std::string_view msg, int line)
 {
+    Output::flush();
     fmt::print("\n[line {}]", line);
     fmt::print(fmt::emphasis::italic | fg(fmt::color::red), " Internal error in ");
     fmt::print(fmt::emphasis::bold | fg(fmt::color::deep_pink), "{}:\n\n", __FILE__);
@@ -45,6 +53,7 @@ void debug_error(std::string_view msg, int line)
 
 void warning(std::string_view msg)
 {
+    Output::flush();
     fmt::print(fmt::emphasis::italic | fg(fmt::color::yellow), " Warning: {}\n\n", msg);
 }
 
@@ -87,6 +96,8 @@ std::string format_msg(const Token& token, fmt::color token_color)
 
 void report_error(int line, int column, std::string_view where, std::string_view src_str, std::string_view msg)
 {
+    // what the script printed before the error comes first
+    Output::flush();
     fmt::print("\n[{}, {}]", line, column);
     fmt::print(fmt::emphasis::italic | fg(fmt::color::red), " Error at '");
     fmt::print(fmt::emphasis::bold | fg(fmt::color::white), "{}", where);
@@ -97,6 +108,7 @@ void report_error(int line, int column, std::string_view where, std::string_view
 
 void report_warning(int line, int column, std::string_view where, std::string_view src_str, std::string_view msg)
 {
+    Output::flush();
     fmt::print("\n[{}, {}]", line, column);
     fmt::print(fmt::emphasis::italic | fg(fmt::color::yellow), " Warning at '");
     fmt::print(fmt::emphasis::bold | fg(fmt::color::white), "{}", where);
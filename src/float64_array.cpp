@@ -0,0 +1,133 @@
+#include "float64_array.h"
+
+#include "array.h"
+#include "frame_pool.h"
+#include "simd/kernels.h"
+
+namespace cpplox
+{
+namespace
+{
+double number_argument(const Value& arg, const Token& paren)
+{
+    if (!arg.m_value.has_value() || !std::holds_alternative<double>(arg.m_value.value()))
+        throw RuntimeError{paren, "Argument must be a number."};
+
+    return std::get<double>(arg.m_value.value());
+}
+
+}
+
+Float64Array::Float64Array(std::vector<double> elements)
+    : m_elements(std::move(elements))
+{
+}
+
+std::shared_ptr<Float64Array> Float64Array::create(std::vector<double> elements)
+{
+    return std::allocate_shared<Float64Array>(FrameAllocator<Float64Array>{}, std::move(elements));
+}
+
+Value Float64Array::get(const Value& index, const Token& bracket) const
+{
+    return static_cast<Value>(m_elements[Array::position(index, m_elements.size(), bracket)]);
+}
+
+void Float64Array::set(const Value& index, const Token& bracket, const Value& value)
+{
+    std::size_t at = Array::position(index, m_elements.size(), bracket);
+    if (!value.m_value.has_value() || !std::holds_alternative<double>(value.m_value.value()))
+        throw RuntimeError{bracket, "Float64Array elements must be numbers."};
+
+    m_elements[at] = std::get<double>(value.m_value.value());
+}
+
+int Float64Array::method_arity(std::string_view name)
+{
+    if (name == "add" || name == "sub" || name == "mul" || name == "dot" || name == "scale" || name == "less" ||
+        name == "greater")
+        return 1;
+    if (name == "sum" || name == "min" || name == "max" || name == "prefix_sum" || name == "to_array")
+        return 0;
+
+    return -1;
+}
+
+Value Float64Array::call_method(const Token& name, const Token& paren, const std::vector<Value>& args) const
+{
+    const simd::Kernels& kernels = simd::kernels();
+    const double* data = m_elements.data();
+    std::size_t n = m_elements.size();
+    const std::string& method = name.lexeme();
+
+    if (method == "sum")
+        return static_cast<Value>(kernels.sum(data, n));
+    if (method == "min" || method == "max")
+    {
+        if (n == 0)
+            return std::nullopt;
+        return static_cast<Value>(method == "min" ? kernels.min(data, n) : kernels.max(data, n));
+    }
+    if (method == "dot")
+        return static_cast<Value>(kernels.dot(data, same_length(args[0], paren).m_elements.data(), n));
+    if (method == "to_array")
+    {
+        std::vector<Value> elements;
+        elements.reserve(n);
+        for (double element : m_elements)
+        {
+            elements.emplace_back(element);
+        }
+        return Array::create(std::move(elements));
+    }
+
+    // the rest return a new typed array
+    std::vector<double> out(n);
+    if (method == "prefix_sum")
+        kernels.prefix_sum(data, out.data(), n);
+    else if (method == "scale")
+        kernels.scale(data, number_argument(args[0], paren), out.data(), n);
+    else if (method == "less")
+        kernels.less(data, number_argument(args[0], paren), out.data(), n);
+    else if (method == "greater")
+        kernels.greater(data, number_argument(args[0], paren), out.data(), n);
+    else
+    {
+        const double* other = same_length(args[0], paren).m_elements.data();
+        if (method == "add")
+            kernels.add(data, other, out.data(), n);
+        else if (method == "sub")
+            kernels.sub(data, other, out.data(), n);
+        else
+            kernels.mul(data, other, out.data(), n);
+    }
+
+    return create(std::move(out));
+}
+
+std::string Float64Array::to_string() const
+{
+    std::string result = "[";
+    NumberBuffer buffer;
+    for (std::size_t i = 0; i < m_elements.size(); i++)
+    {
+        if (i != 0)
+            result += ", ";
+        result += format_number(m_elements[i], buffer);
+    }
+
+    return result + "]";
+}
+
+const Float64Array& Float64Array::same_length(const Value& arg, const Token& paren) const
+{
+    auto other = arg.m_value.has_value() ? std::get_if<std::shared_ptr<Float64Array>>(&arg.m_value.value()) : nullptr;
+    if (other == nullptr)
+        throw RuntimeError{paren, "Argument must be a Float64Array."};
+    if ((*other)->length() != length())
+        throw RuntimeError{paren, "Float64Arrays must have the same length."};
+
+    return **other;
+}
+
+}
@@ -0,0 +1,75 @@
+#include "frame_pool.h"
+
+#include <array>
+#include <new>
+
+namespace cpplox
+{
+namespace
+{
+// A freed block stores the pointer to the next free block of its size class
+struct FreeBlock
+{
+    FreeBlock* next;
+};
+
+// block sizes are rounded up to this
+constexpr std::size_t GRANULARITY = 16;
+// bigger blocks go straight to `operator new`
+constexpr std::size_t MAX_BLOCK = 1024;
+constexpr std::size_t CHUNK_SIZE = 64 * 1024;
+
+std::array<FreeBlock*, MAX_BLOCK / GRANULARITY + 1> g_free_lists{};
+// the unused tail of the current chunk
+char* g_bump = nullptr;
+char* g_bump_end = nullptr;
+
+std::size_t size_class(std::size_t bytes)
+{
+    return (bytes + GRANULARITY - 1) / GRANULARITY;
+}
+
+}
+
+void* FramePool::allocate(std::size_t bytes)
+{
+    if (bytes > MAX_BLOCK)
+        return ::operator new(bytes);
+
+    std::size_t index = size_class(bytes);
+    FreeBlock* block = g_free_lists[index];
+    if (block != nullptr)
+    {
+        g_free_lists[index] = block->next;
+        return block;
+    }
+
+    std::size_t size = index * GRANULARITY;
+    if (g_bump == nullptr || g_bump_end - g_bump < size)
+    {
+        // the rest of the old chunk is wasted, which is at most MAX_BLOCK bytes.
+        // Chunks are never freed - the memory is reused through the free lists
+        g_bump = static_cast<char*>(::operator new(CHUNK_SIZE));
+        g_bump_end = g_bump + CHUNK_SIZE;
+    }
+
+    void* ptr = g_bump;
+    g_bump += size;
+    return ptr;
+}
+
+void FramePool::deallocate(void* ptr, std::size_t bytes)
+{
+    if (bytes > MAX_BLOCK)
+    {
+        ::operator delete(ptr);
+        return;
+    }
+
+    std::size_t index = size_class(bytes);
+    auto* block = static_cast<FreeBlock*>(ptr);
+    block->next = g_free_lists[index];
+    g_free_lists[index] = block;
+}
+
+}
@@ -1,44 +1,96 @@
 #include "function.h"
 
+#include "frame_pool.h"
 #include "interpreter.h"
+#include "jit/jit.h"
 
 namespace cpplox
 {
 Value Function::call(Interpreter *interpreter, const std::vector<Value> &args)
 {
-    auto env = std::make_shared<Environment>(m_closure);
-
-    for (int i = 0; i < m_declaration->m_params.size(); i++)
+    auto frame = new_frame();
+    for (const Value &arg : args)
     {
-        env->define(m_declaration->m_params.at(i).lexeme(), args.at(i));
+        frame->define(arg);
     }
 
-    // bad. bad. bad
-    try
+    return run(interpreter, std::move(frame));
+}
+
+Value Function::call_method(Interpreter *interpreter, const std::shared_ptr<Instance> &instance,
+                            const std::vector<Value> &args)
+{
+    auto frame = new_method_frame(instance);
+    for (const Value &arg : args)
     {
-        interpreter->execute_block(m_declaration->m_body, env);
+        frame->define(arg);
     }
-    catch (Return &return_value)
+
+    return run(interpreter, std::move(frame));
+}
+
+std::shared_ptr<Environment> Function::new_frame() const
+{
+    return Environment::create(m_closure, m_declaration->m_slots);
+}
+
+std::shared_ptr<Environment> Function::new_method_frame(const std::shared_ptr<Instance> &instance) const
+{
+    // the same scope `bind()` would create, minus the function object
+    auto this_env = Environment::create(m_closure, 1);
+    this_env->define(instance);
+    return Environment::create(this_env, m_declaration->m_slots);
+}
+
+Value Function::run(Interpreter *interpreter, std::shared_ptr<Environment> frame)
+{
+    Function *function = this;
+    std::shared_ptr<Function> callee;
+    std::optional<Value> compiled_result;
+
+    while (true)
     {
-        // allow using `return;` in initializers
-        if (m_is_initializer)
-            return m_closure->get_at(0, "this");
+        ast::stmt::Function *declaration = function->m_declaration.get();
+        if (Jit::enabled())
+        {
+            compiled_result = Jit::run(*interpreter, declaration, *frame);
+            if (compiled_result.has_value())
+                break;
+        }
+
+        // loops in the body count towards the function's hotness
+        uint32_t *caller_counter =
+            interpreter->count_loops_in(Jit::enabled() ? &declaration->m_tier.m_hotness : nullptr);
+        interpreter->execute_block(declaration->m_body, frame);
+        interpreter->count_loops_in(caller_counter);
 
-        return return_value.m_value;
+        std::optional<TailCall> tail_call = interpreter->take_tail_call();
+        if (!tail_call.has_value())
+            break;
+
+        // the finished frame is released here (unless a closure holds on to it),
+        // so the pool hands the same memory to the next tail call
+        callee = std::move(tail_call->function);
+        frame = std::move(tail_call->frame);
+        function = callee.get();
     }
 
-    // No return statement
-    if (m_is_initializer)
-        return m_closure->get_at(0, "this");
+    Value value = compiled_result.has_value() ? std::move(compiled_result.value()) : interpreter->take_return_value();
+
+    // initializers always return `this`, which is the only variable in the enclosing scope.
+    // This also allows using `return;` in initializers
+    if (function->m_is_initializer)
+        return frame->m_enclosing->get_at(0, 0);
 
-    return std::nullopt;
+    return value;
 }
 
 std::shared_ptr<Function> Function::bind(const std::shared_ptr<Instance> &instance)
 {
-    auto env = std::make_shared<Environment>(m_closure);
-    env->define("this", instance);
-    return std::make_shared<Function>(m_declaration, env, m_is_initializer, m_is_static);
+    auto env = Environment::create(m_closure, 1);
+    env->define(instance);
+    return std::allocate_shared<Function>(FrameAllocator<Function>{}, m_declaration, env, m_is_initializer,
+                                          m_is_static);
 }
 
 }
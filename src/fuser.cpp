@@ -0,0 +1,343 @@
+#include "fuser.h"
+
+namespace cpplox
+{
+namespace
+{
+bool is_arithmetic(TokenType type)
+{
+    return type == TokenType::PLUS || type == TokenType::MINUS || type == TokenType::STAR || type == TokenType::SLASH;
+}
+
+bool is_comparison(TokenType type)
+{
+    return type == TokenType::GREATER || type == TokenType::GREATER_EQUAL || type == TokenType::LESS ||
+           type == TokenType::LESS_EQUAL || type == TokenType::EQUAL_EQUAL || type == TokenType::BANG_EQUAL;
+}
+
+}
+
+void Fuser::run()
+{
+    for (auto &stmt : m_interpreter.statements())
+    {
+        fuse(stmt.get());
+    }
+}
+
+void Fuser::visit(stmt::Block *stmt)
+{
+    fuse(stmt->m_statements);
+}
+
+void Fuser::visit(stmt::Var *stmt)
+{
+    if (stmt->m_initializer.has_value())
+        fuse(stmt->m_initializer.value());
+}
+
+void Fuser::visit(stmt::Function *stmt)
+{
+    fuse(stmt->m_body);
+}
+
+void Fuser::visit(stmt::Expression *stmt)
+{
+    fuse(stmt->m_expr);
+}
+
+void Fuser::visit(stmt::If *stmt)
+{
+    fuse(stmt->m_condition);
+    stmt->m_fused_condition = dynamic_cast<expr::CompareLocals *>(stmt->m_condition.get());
+
+    fuse(stmt->m_then.get());
+    if (stmt->m_else.has_value())
+        fuse(stmt->m_else->get());
+}
+
+void Fuser::visit(stmt::Print *stmt)
+{
+    fuse(stmt->m_expr);
+}
+
+void Fuser::visit(stmt::Return *stmt)
+{
+    if (stmt->m_value.has_value())
+        fuse(stmt->m_value.value());
+}
+
+void Fuser::visit(stmt::While *stmt)
+{
+    fuse(stmt->m_condition);
+    stmt->m_fused_condition = dynamic_cast<expr::CompareLocals *>(stmt->m_condition.get());
+
+    fuse(stmt->m_stmt.get());
+}
+
+void Fuser::visit(stmt::Class *stmt)
+{
+    for (const auto &method : stmt->m_methods)
+    {
+        fuse(method.get());
+    }
+}
+
+void Fuser::visit(stmt::Import *)
+{
+    // imported statements are already in the interpreter's list
+}
+
+Value Fuser::visit(expr::Variable *)
+{
+    return std::nullopt;
+}
+
+Value Fuser::visit(expr::Assign *expr)
+{
+    fuse(expr->m_value);
+    return std::nullopt;
+}
+
+Value Fuser::visit(expr::Lambda *expr)
+{
+    fuse(expr->m_body);
+    return std::nullopt;
+}
+
+Value Fuser::visit(expr::Binary *expr)
+{
+    fuse(expr->m_left);
+    fuse(expr->m_right);
+    return std::nullopt;
+}
+
+Value Fuser::visit(expr::Call *expr)
+{
+    fuse(expr->m_callee);
+    for (auto &arg : expr->m_args)
+    {
+        fuse(arg);
+    }
+
+    return std::nullopt;
+}
+
+Value Fuser::visit(expr::Grouping *expr)
+{
+    fuse(expr->m_expression);
+    return std::nullopt;
+}
+
+Value Fuser::visit(expr::Literal *)
+{
+    return std::nullopt;
+}
+
+Value Fuser::visit(expr::Logical *expr)
+{
+    fuse(expr->m_left);
+    fuse(expr->m_right);
+    return std::nullopt;
+}
+
+Value Fuser::visit(expr::Unary *expr)
+{
+    fuse(expr->m_right);
+    return std::nullopt;
+}
+
+Value Fuser::visit(expr::Get *expr)
+{
+    fuse(expr->m_object);
+    return std::nullopt;
+}
+
+Value Fuser::visit(expr::Set *expr)
+{
+    fuse(expr->m_object);
+    fuse(expr->m_value);
+    return std::nullopt;
+}
+
+Value Fuser::visit(expr::This *)
+{
+    return std::nullopt;
+}
+
+Value Fuser::visit(expr::Super *)
+{
+    return std::nullopt;
+}
+
+Value Fuser::visit(expr::Invoke *expr)
+{
+    fuse(expr->m_object);
+    for (auto &arg : expr->m_args)
+    {
+        fuse(arg);
+    }
+
+    return std::nullopt;
+}
+
+Value Fuser::visit(expr::ArrayLiteral *expr)
+{
+    for (auto &element : expr->m_elements)
+    {
+        fuse(element);
+    }
+
+    return std::nullopt;
+}
+
+Value Fuser::visit(expr::Subscript *expr)
+{
+    fuse(expr->m_object);
+    fuse(expr->m_index);
+    return std::nullopt;
+}
+
+Value Fuser::visit(expr::SetSubscript *expr)
+{
+    fuse(expr->m_object);
+    fuse(expr->m_index);
+    fuse(expr->m_value);
+    return std::nullopt;
+}
+
+Value Fuser::visit(expr::UpdateLocal *)
+{
+    return std::nullopt;
+}
+
+Value Fuser::visit(expr::CompareLocals *)
+{
+    return std::nullopt;
+}
+
+Value Fuser::visit(expr::UpdateField *)
+{
+    return std::nullopt;
+}
+
+void Fuser::fuse(stmt::Statement *stmt)
+{
+    // statements with parse errors are null
+    if (stmt != nullptr)
+        stmt->accept(this);
+}
+
+void Fuser::fuse(const std::vector<StatementPtr> &stmts)
+{
+    for (const auto &stmt : stmts)
+    {
+        fuse(stmt.get());
+    }
+}
+
+void Fuser::fuse(ExpressionPtr &expr)
+{
+    if (expr == nullptr)
+        return;
+
+    expr->accept(this);
+
+    ExpressionPtr fused;
+    if (auto assign = std::dynamic_pointer_cast<expr::Assign>(expr))
+        fused = fuse_update_local(assign);
+    else if (auto binary = std::dynamic_pointer_cast<expr::Binary>(expr))
+        fused = fuse_compare(binary);
+    else if (auto set = std::dynamic_pointer_cast<expr::Set>(expr))
+        fused = fuse_update_field(set);
+
+    if (fused != nullptr)
+        expr = fused;
+}
+
+ExpressionPtr Fuser::fuse_update_local(const std::shared_ptr<expr::Assign> &assign)
+{
+    // x = x op value
+    auto binary = std::dynamic_pointer_cast<expr::Binary>(assign->m_value);
+    if (binary == nullptr || !is_arithmetic(binary->m_op.token_type()))
+        return nullptr;
+
+    auto variable = std::dynamic_pointer_cast<expr::Variable>(binary->m_left);
+    if (variable == nullptr || variable->m_name.lexeme() != assign->m_name.lexeme())
+        return nullptr;
+
+    std::optional<LocalSlot> target = m_interpreter.local_slot(assign.get());
+    std::optional<LocalSlot> source = m_interpreter.local_slot(variable.get());
+    if (!target.has_value() || !source.has_value() || target->depth != source->depth ||
+        target->slot != source->slot)
+        return nullptr;
+
+    auto fused = std::make_shared<expr::UpdateLocal>(binary, target->depth, target->slot);
+    if (auto literal = std::dynamic_pointer_cast<expr::Literal>(binary->m_right))
+        fused->m_constant = *literal->m_value;
+
+    return fused;
+}
+
+ExpressionPtr Fuser::fuse_compare(const std::shared_ptr<expr::Binary> &binary)
+{
+    if (!is_comparison(binary->m_op.token_type()))
+        return nullptr;
+
+    std::optional<expr::Operand> left = operand(binary->m_left);
+    std::optional<expr::Operand> right = operand(binary->m_right);
+    // comparing two constants isn't worth it
+    if (!left.has_value() || !right.has_value() || (left->m_depth == -1 && right->m_depth == -1))
+        return nullptr;
+
+    return std::make_shared<expr::CompareLocals>(binary, left.value(), right.value());
+}
+
+ExpressionPtr Fuser::fuse_update_field(const std::shared_ptr<expr::Set> &set)
+{
+    // object.field = object.field op value
+    auto binary = std::dynamic_pointer_cast<expr::Binary>(set->m_value);
+    if (binary == nullptr || !is_arithmetic(binary->m_op.token_type()))
+        return nullptr;
+
+    auto get = std::dynamic_pointer_cast<expr::Get>(binary->m_left);
+    if (get == nullptr || get->m_name.lexeme() != set->m_name.lexeme() || !same_local(get->m_object, set->m_object))
+        return nullptr;
+
+    LocalSlot object = m_interpreter.local_slot(set->m_object.get()).value();
+    return std::make_shared<expr::UpdateField>(set, binary, object.depth, object.slot);
+}
+
+std::optional<expr::Operand> Fuser::operand(const ExpressionPtr &expr)
+{
+    if (auto literal = std::dynamic_pointer_cast<expr::Literal>(expr))
+        return expr::Operand{-1, 0, *literal->m_value};
+
+    if (std::dynamic_pointer_cast<expr::Variable>(expr) == nullptr)
+        return std::nullopt;
+
+    std::optional<LocalSlot> local = m_interpreter.local_slot(expr.get());
+    if (!local.has_value())
+        return std::nullopt;
+
+    return expr::Operand{local->depth, local->slot, std::nullopt};
+}
+
+bool Fuser::same_local(const ExpressionPtr &first, const ExpressionPtr &second)
+{
+    auto first_variable = std::dynamic_pointer_cast<expr::Variable>(first);
+    auto second_variable = std::dynamic_pointer_cast<expr::Variable>(second);
+    bool variables = first_variable != nullptr && second_variable != nullptr &&
+                     first_variable->m_name.lexeme() == second_variable->m_name.lexeme();
+    bool this_exprs = std::dynamic_pointer_cast<expr::This>(first) != nullptr &&
+                      std::dynamic_pointer_cast<expr::This>(second) != nullptr;
+    if (!variables && !this_exprs)
+        return false;
+
+    std::optional<LocalSlot> first_local = m_interpreter.local_slot(first.get());
+    std::optional<LocalSlot> second_local = m_interpreter.local_slot(second.get());
+    return first_local.has_value() && second_local.has_value() && first_local->depth == second_local->depth &&
+           first_local->slot == second_local->slot;
+}
+
+}
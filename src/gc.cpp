@@ -0,0 +1,289 @@
+#include "gc.h"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "array.h"
+#include "fmt/core.h"
+#include "instance.h"
+#include "map.h"
+#include "record_array.h"
+
+namespace cpplox
+{
+namespace
+{
+// upper bounds of the pause histogram buckets in milliseconds - the last bucket is open
+constexpr std::array<double, 7> BUCKET_BOUNDS = {0.1, 0.25, 0.5, 1, 2.5, 5, 10};
+
+struct PauseStats
+{
+    uint64_t collections = 0;
+    std::chrono::nanoseconds total{0};
+    std::chrono::nanoseconds max{0};
+    std::array<uint64_t, BUCKET_BOUNDS.size() + 1> buckets{};
+
+    void add(std::chrono::nanoseconds pause)
+    {
+        collections++;
+        total += pause;
+        max = std::max(max, pause);
+
+        double ms = std::chrono::duration<double, std::milli>(pause).count();
+        auto bucket = std::upper_bound(BUCKET_BOUNDS.begin(), BUCKET_BOUNDS.end(), ms);
+        buckets[bucket - BUCKET_BOUNDS.begin()]++;
+    }
+};
+
+struct Stats
+{
+    PauseStats minor;
+    PauseStats major;
+    uint64_t freed = 0;
+    uint64_t promoted = 0;
+};
+
+Stats g_stats;
+
+}
+
+// Counts the references objects get from other objects of the collected generations
+class GarbageCollector::RefCounter : public Tracer
+{
+public:
+    explicit RefCounter(bool major)
+        : m_major(major)
+    {
+    }
+
+protected:
+    bool visit(Traceable* object, long use_count) override
+    {
+        if (object->m_old && !m_major)
+            return false;
+
+        object->m_internal_refs++;
+        object->m_use_count = use_count;
+        return false;
+    }
+
+private:
+    bool m_major;
+};
+
+// Marks everything reachable from the objects on the stack
+class GarbageCollector::Marker : public Tracer
+{
+public:
+    explicit Marker(bool major)
+        : m_major(major)
+    {
+    }
+
+    std::vector<Traceable*> m_stack;
+
+protected:
+    bool visit(Traceable* object, long) override
+    {
+        if (object->m_marked || (object->m_old && !m_major))
+            return false;
+
+        object->m_marked = true;
+        m_stack.push_back(object);
+        return false;
+    }
+
+private:
+    bool m_major;
+};
+
+// Takes an owning pointer to every unmarked object it sees
+class GarbageCollector::GarbageKeeper : public Tracer
+{
+public:
+    explicit GarbageKeeper(bool major)
+        : m_major(major)
+    {
+    }
+
+    std::vector<std::shared_ptr<Traceable>> m_garbage;
+
+protected:
+    bool visit(Traceable* object, long) override
+    {
+        if (object->m_marked || (object->m_old && !m_major))
+            return false;
+
+        object->m_marked = true;
+        return true;
+    }
+    void own(std::shared_ptr<Traceable> object) override
+    {
+        m_garbage.push_back(std::move(object));
+    }
+
+private:
+    bool m_major;
+};
+
+void Tracer::edge(const Value& value)
+{
+    if (!value.m_value.has_value())
+        return;
+
+    if (auto callable = std::get_if<std::shared_ptr<Callable>>(&value.m_value.value()))
+        edge(*callable);
+    else if (auto instance = std::get_if<std::shared_ptr<Instance>>(&value.m_value.value()))
+        edge(*instance);
+    else if (auto array = std::get_if<std::shared_ptr<Array>>(&value.m_value.value()))
+        edge(*array);
+    else if (auto map = std::get_if<std::shared_ptr<Map>>(&value.m_value.value()))
+        edge(*map);
+    else if (auto records = std::get_if<std::shared_ptr<RecordArray>>(&value.m_value.value()))
+        edge(*records);
+}
+
+void GarbageCollector::collect()
+{
+    collect(s_old_count >= s_major_threshold);
+}
+
+void GarbageCollector::collect(bool major)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    // the objects this collection looks at
+    std::vector<Traceable*> objects;
+    objects.reserve(s_young_count + (major ? s_old_count : 0));
+    for (Traceable* object = s_young; object != nullptr; object = object->m_next)
+        objects.push_back(object);
+    if (major)
+    {
+        for (Traceable* object = s_old; object != nullptr; object = object->m_next)
+            objects.push_back(object);
+    }
+
+    for (Traceable* object : objects)
+    {
+        object->m_internal_refs = 0;
+        object->m_use_count = -1;
+        object->m_marked = false;
+    }
+
+    RefCounter counter{major};
+    for (Traceable* object : objects)
+        object->trace(counter);
+
+    // an object that isn't referenced by the collected generations at all is owned from the outside
+    Marker marker{major};
+    for (Traceable* object : objects)
+    {
+        if (object->m_use_count < 0 || object->m_use_count > object->m_internal_refs)
+        {
+            object->m_marked = true;
+            marker.m_stack.push_back(object);
+        }
+    }
+
+    while (!marker.m_stack.empty())
+    {
+        Traceable* object = marker.m_stack.back();
+        marker.m_stack.pop_back();
+        object->trace(marker);
+    }
+
+    // Every unmarked object is referenced by another unmarked object,
+    // so tracing the garbage yields an owning pointer to all of it.
+    // The keeper marks what it takes, so the unmarked objects are picked out first.
+    std::erase_if(objects, [](Traceable* object) { return object->m_marked; });
+
+    GarbageKeeper keeper{major};
+    for (Traceable* object : objects)
+        object->trace(keeper);
+
+    for (auto& object : keeper.m_garbage)
+        object->clear_references();
+
+    g_stats.freed += keeper.m_garbage.size();
+    keeper.m_garbage.clear();
+
+    promote();
+    if (major)
+        s_major_threshold = std::max(MIN_MAJOR_THRESHOLD, 2 * s_old_count);
+
+    auto pause = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    (major ? g_stats.major : g_stats.minor).add(pause);
+    if (!major)
+        resize_nursery(pause);
+}
+
+void GarbageCollector::resize_nursery(std::chrono::nanoseconds pause)
+{
+    if (pause > MINOR_PAUSE_BUDGET)
+        s_nursery_size = std::max(MIN_NURSERY_SIZE, s_nursery_size / 2);
+    // a quarter of the budget leaves room for the pause to double
+    else if (pause < MINOR_PAUSE_BUDGET / 4)
+        s_nursery_size = std::min(MAX_NURSERY_SIZE, s_nursery_size * 2);
+}
+
+void GarbageCollector::promote()
+{
+    if (s_young == nullptr)
+        return;
+
+    Traceable* last = s_young;
+    last->m_old = true;
+    while (last->m_next != nullptr)
+    {
+        last = last->m_next;
+        last->m_old = true;
+    }
+
+    // put the whole young list in front of the old one
+    last->m_next = s_old;
+    if (s_old != nullptr)
+        s_old->m_prev = last;
+    s_old = s_young;
+    s_young = nullptr;
+
+    g_stats.promoted += s_young_count;
+    s_old_count += s_young_count;
+    s_young_count = 0;
+}
+
+void GarbageCollector::print_stats()
+{
+    using std::chrono::duration;
+
+    s_peak = std::max(s_peak, s_young_count + s_old_count);
+
+    fmt::print(stderr, "{:<8}{:>12}{:>14}{:>14}{:>14}\n", "gc", "collections", "total ms", "mean ms", "max ms");
+    for (auto [name, pauses] : {std::pair{"minor", g_stats.minor}, std::pair{"major", g_stats.major}})
+    {
+        double total_ms = duration<double, std::milli>(pauses.total).count();
+        double mean_ms = pauses.collections == 0 ? 0 : total_ms / pauses.collections;
+        fmt::print(stderr, "{:<8}{:>12}{:>14.3f}{:>14.3f}{:>14.3f}\n", name, pauses.collections, total_ms, mean_ms,
+                   duration<double, std::milli>(pauses.max).count());
+    }
+
+    fmt::print(stderr, "\npause histogram\n{:<8}", "ms");
+    for (double bound : BUCKET_BOUNDS)
+        fmt::print(stderr, "{:>8}", fmt::format("<{}", bound));
+    fmt::print(stderr, "{:>8}\n", fmt::format(">={}", BUCKET_BOUNDS.back()));
+    for (auto [name, pauses] : {std::pair{"minor", g_stats.minor}, std::pair{"major", g_stats.major}})
+    {
+        fmt::print(stderr, "{:<8}", name);
+        for (uint64_t count : pauses.buckets)
+            fmt::print(stderr, "{:>8}", count);
+        fmt::print(stderr, "\n");
+    }
+
+    fmt::print(stderr, "\nobjects freed:    {}\n", g_stats.freed);
+    fmt::print(stderr, "objects promoted: {}\n", g_stats.promoted);
+    fmt::print(stderr, "live objects:     {} young, {} old\n", s_young_count, s_old_count);
+    fmt::print(stderr, "peak objects:     {}\n", s_peak);
+    fmt::print(stderr, "nursery size:     {}\n", s_nursery_size);
+}
+
+}
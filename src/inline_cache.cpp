@@ -0,0 +1,97 @@
+#include "inline_cache.h"
+
+#include "fmt/core.h"
+
+namespace cpplox
+{
+namespace
+{
+struct Counters
+{
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    // lookups done by sites that gave up caching
+    uint64_t megamorphic = 0;
+    // sites that saw more than one shape
+    uint64_t polymorphic_sites = 0;
+    uint64_t megamorphic_sites = 0;
+};
+
+std::array<Counters, 5> g_counters;
+
+Counters& counters(InlineCache::Kind kind)
+{
+    return g_counters.at(static_cast<int>(kind));
+}
+
+}
+
+const InlineCache::Entry* InlineCache::lookup(const Shape* shape)
+{
+    if (m_state == State::MEGAMORPHIC)
+    {
+        counters(m_kind).megamorphic++;
+        return nullptr;
+    }
+
+    for (int i = 0; i < m_size; i++)
+    {
+        if (m_keys[i] == shape && !m_entries[i].m_shape.expired())
+        {
+            counters(m_kind).hits++;
+            return &m_entries[i];
+        }
+    }
+
+    counters(m_kind).misses++;
+    return nullptr;
+}
+
+void InlineCache::update(const std::shared_ptr<Shape>& shape, int slot, const std::shared_ptr<Shape>& transition,
+                         const std::shared_ptr<Function>& method)
+{
+    switch (m_state)
+    {
+        case State::UNINITIALIZED:
+            m_state = State::MONOMORPHIC;
+            break;
+        case State::MONOMORPHIC:
+            m_state = State::POLYMORPHIC;
+            counters(m_kind).polymorphic_sites++;
+            break;
+        case State::POLYMORPHIC:
+            if (m_size < MAX_ENTRIES)
+                break;
+
+            // drop the entries - a megamorphic site always does the full lookup
+            m_state = State::MEGAMORPHIC;
+            m_entries = {};
+            m_keys = {};
+            m_size = 0;
+            counters(m_kind).megamorphic_sites++;
+            return;
+        case State::MEGAMORPHIC:
+            return;
+    }
+
+    m_keys[m_size] = shape.get();
+    m_entries[m_size++] = Entry{shape, slot, transition, method};
+}
+
+void InlineCache::print_stats()
+{
+    constexpr std::array<const char*, 5> names = {"get", "set", "super", "invoke", "update"};
+
+    fmt::print(stderr, "{:<8}{:>14}{:>14}{:>14}{:>10}{:>14}{:>14}\n", "site", "hits", "misses", "megamorphic",
+               "hit rate", "poly sites", "mega sites");
+    for (int i = 0; i < g_counters.size(); i++)
+    {
+        const Counters& c = g_counters[i];
+        uint64_t total = c.hits + c.misses + c.megamorphic;
+        double hit_rate = total == 0 ? 0 : 100.0 * c.hits / total;
+        fmt::print(stderr, "{:<8}{:>14}{:>14}{:>14}{:>9.1f}%{:>14}{:>14}\n", names[i], c.hits, c.misses,
+                   c.megamorphic, hit_rate, c.polymorphic_sites, c.megamorphic_sites);
+    }
+}
+
+}
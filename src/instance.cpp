@@ -4,16 +4,24 @@
 
 namespace cpplox
 {
+Instance::Instance(const std::shared_ptr<Class>& klass)
+    : m_class(klass)
+    , m_shape(klass->root_shape())
+    , m_fields(m_shape->size(), Value{std::nullopt})
+{
+}
+
 Value Instance::get(const Token& name)
 {
-    if (m_fields.contains(name.lexeme()))
-        return m_fields.at(name.lexeme());
+    int slot = m_shape->lookup(name.lexeme());
+    if (slot != -1)
+        return m_fields[slot];
 
     auto method = m_class->find_method(name.lexeme());
     if (method.has_value())
     {
-        auto this_ptr = std::make_shared<Instance>(*this);
-        return std::dynamic_pointer_cast<Callable>(method.value()->bind(this_ptr));
+        // the method is used as a value, so it has to be bound to this instance
+        return std::dynamic_pointer_cast<Callable>(method.value()->bind(shared_from_this()));
     }
 
     throw RuntimeError{name, "Undefined property '" + name.lexeme() + "'."};
@@ -21,21 +29,45 @@ Value Instance::get(const Token& name)
 
 void Instance::set(const Token& name, const Value& value)
 {
-    auto field = m_fields.find(name.lexeme());
-    if (field != m_fields.end())
+    int slot = m_shape->lookup(name.lexeme());
+    if (slot != -1)
     {
-        field->second = value;
+        m_fields[slot] = value;
     }
     else
     {
+        if (m_shape->sealed())
+            throw RuntimeError{name, "Record '" + m_class->m_name + "' has no field '" + name.lexeme() + "'."};
+
         // cpplox allows creating new fields on instances
-        m_fields.emplace(name.lexeme(), value);
+        add_field(m_shape->with_field(name.lexeme()), value);
+    }
+}
+
+void Instance::add_field(const std::shared_ptr<Shape>& shape, const Value& value)
+{
+    m_shape = shape;
+    m_fields.push_back(value);
+}
+
+void Instance::trace(Tracer& tracer) const
+{
+    tracer.edge(m_class);
+    for (const Value& field : m_fields)
+    {
+        tracer.edge(field);
     }
 }
 
+void Instance::clear_references()
+{
+    m_class.reset();
+    m_fields.clear();
+}
+
 std::string Instance::to_string() const
 {
     return "<instance " + m_class->m_name + ">";
 }
 
-}
\ No newline at end of file
+}
@@ -1,6 +1,15 @@
 #include "interpreter.h"
 
+#include "array.h"
+#include "float64_array.h"
+#include "frame_pool.h"
 #include "instance.h"
+#include "jit/jit.h"
+#include "json.h"
+#include "map.h"
+#include "output.h"
+#include "record_array.h"
+#include "string_builder.h"
 
 namespace cpplox
 {
@@ -48,6 +57,8 @@ Value Interpreter::visit(expr::Unary *expr)
             return static_cast<Value>(-std::get<double>(right.m_value.value()));
         case TokenType::BANG:
             return static_cast<Value>(!is_true(right));
+        default:
+            break;
     }
 
     return std::nullopt;
@@ -58,6 +69,11 @@ Value Interpreter::visit(expr::Binary *expr)
     Value left = evaluate(expr->m_left.get());
     Value right = evaluate(expr->m_right.get());
 
+    return binary(expr, left, right);
+}
+
+Value Interpreter::binary(expr::Binary *expr, const Value &left, const Value &right)
+{
     bool has_value = left.m_value.has_value() && right.m_value.has_value();
 
     // extract the values beforehand to avoid repetition
@@ -75,6 +91,34 @@ Value Interpreter::visit(expr::Binary *expr)
         }
     }
 
+    // numbers are the common case, so they skip the operand checks below
+    if (is_numbers)
+    {
+        switch (expr->m_op.token_type())
+        {
+            case TokenType::PLUS:
+                return static_cast<Value>(dleft + dright);
+            case TokenType::MINUS:
+                return static_cast<Value>(dleft - dright);
+            case TokenType::STAR:
+                return static_cast<Value>(dleft * dright);
+            case TokenType::LESS:
+                return static_cast<Value>(dleft < dright);
+            case TokenType::LESS_EQUAL:
+                return static_cast<Value>(dleft <= dright);
+            case TokenType::GREATER:
+                return static_cast<Value>(dleft > dright);
+            case TokenType::GREATER_EQUAL:
+                return static_cast<Value>(dleft >= dright);
+            case TokenType::EQUAL_EQUAL:
+                return static_cast<Value>(dleft == dright);
+            case TokenType::BANG_EQUAL:
+                return static_cast<Value>(dleft != dright);
+            default:
+                break;
+        }
+    }
+
     switch (expr->m_op.token_type())
     {
             /* Arithmetic */
@@ -88,10 +132,10 @@ Value Interpreter::visit(expr::Binary *expr)
             if (!has_value)
                 break;
 
-            if (std::holds_alternative<std::string>(left.m_value.value()) ||
-                std::holds_alternative<std::string>(right.m_value.value()))
+            if (std::holds_alternative<std::shared_ptr<String>>(left.m_value.value()) ||
+                std::holds_alternative<std::shared_ptr<String>>(right.m_value.value()))
             {
-                return left.to_string() + right.to_string();
+                return String::concat(to_string_object(left), to_string_object(right));
             }
 
         case TokenType::SLASH:
@@ -119,6 +163,8 @@ Value Interpreter::visit(expr::Binary *expr)
             return static_cast<Value>(!is_equal(left, right));
         case TokenType::EQUAL_EQUAL:
             return static_cast<Value>(is_equal(left, right));
+        default:
+            break;
     }
 
     return std::nullopt;
@@ -133,16 +179,14 @@ Value Interpreter::visit(expr::Assign *expr)
 {
     Value val = evaluate(expr->m_value.get());
 
-    auto distance = m_locals.find(expr);
-    if (distance != m_locals.end())
+    auto local = m_locals.find(expr);
+    if (local != m_locals.end())
     {
-        m_env->assign_at(distance->second, expr->m_name, val);
+        m_env->assign_at(local->second.depth, local->second.slot, val);
     }
     else
         m_globals->assign(expr->m_name, val);
 
-    m_env->assign(expr->m_name, val);
-
     return val;
 }
 
@@ -166,46 +210,50 @@ Value Interpreter::visit(expr::Logical *expr)
 
 Value Interpreter::visit(expr::Call *expr)
 {
+    bool is_tail_call = std::exchange(m_tail_position, false);
     Value callee = evaluate(expr->m_callee.get());
 
-    std::vector<Value> args;
-    for (const auto &arg : expr->m_args)
-    {
-        args.emplace_back(evaluate(arg.get()));
-    }
-
-    // check if the `callee` is actually something we can call
-    try
+    // user-defined functions get their arguments evaluated straight into the new frame
+    if (callee.m_value.has_value() && std::holds_alternative<std::shared_ptr<Callable>>(callee.m_value.value()))
     {
-        std::get<std::shared_ptr<Callable>>(callee.m_value.value());
-    }
-    catch (std::bad_variant_access &e)
-    {
-        throw RuntimeError{expr->m_paren, "Can only call functions and classes."};
-    }
+        const auto &callable = std::get<std::shared_ptr<Callable>>(callee.m_value.value());
+        auto function = dynamic_cast<Function *>(callable.get());
+        if (function != nullptr && function->arity() == expr->m_args.size())
+        {
+            auto frame = function->new_frame();
+            for (const auto &arg : expr->m_args)
+            {
+                frame->define(evaluate(arg.get()));
+            }
 
-    auto function = std::get<std::shared_ptr<Callable>>(callee.m_value.value());
+            if (is_tail_call)
+            {
+                m_tail_call = TailCall{std::shared_ptr<Function>(callable, function), frame};
+                return std::nullopt;
+            }
 
-    // check for right number of arguments
-    if (args.size() != function->arity())
-    {
-        throw RuntimeError{expr->m_paren, "Expected " + std::to_string(function->arity()) + " arguments, but got " +
-                                              std::to_string(args.size()) + "."};
+            return function->run(this, std::move(frame));
+        }
     }
 
-    return function->call(this, args);
+    std::vector<Value> args = evaluate_args(expr->m_args);
+
+    return call_value(callee, expr->m_paren, args);
 }
 
 Value Interpreter::visit(expr::Lambda *expr)
 {
     auto lambda_expr = std::make_shared<expr::Lambda>(*expr);
-    auto lambda = std::make_shared<Lambda>(lambda_expr);
+    auto lambda = std::allocate_shared<Lambda>(FrameAllocator<Lambda>{}, lambda_expr, m_env);
     return std::dynamic_pointer_cast<Callable>(lambda);
 }
 
 Value Interpreter::visit(expr::Get *expr)
 {
     Value object = evaluate(expr->m_object.get());
+    if (!object.m_value.has_value())
+        throw RuntimeError{expr->m_name, "Only instances and classes have properties."};
+
     switch (object.m_value->index())
     {
         case 3:
@@ -221,7 +269,80 @@ Value Interpreter::visit(expr::Get *expr)
         case 4:
         {
             // `instance.property` syntax
-            return std::get<std::shared_ptr<Instance>>(object.m_value.value())->get(expr->m_name);
+            auto instance = std::get<std::shared_ptr<Instance>>(object.m_value.value());
+            if (instance->shape() == nullptr)
+                return instance->get(expr->m_name);
+
+            const InlineCache::Entry *entry = expr->m_cache.lookup(instance->shape().get());
+            if (entry != nullptr)
+            {
+                if (entry->m_slot != -1)
+                    return instance->field(entry->m_slot);
+
+                return std::dynamic_pointer_cast<Callable>(entry->m_method.lock()->bind(instance));
+            }
+
+            // slow path: do the full lookup and remember the result
+            int slot = instance->shape()->lookup(expr->m_name.lexeme());
+            if (slot != -1)
+            {
+                expr->m_cache.update(instance->shape(), slot, nullptr, nullptr);
+                return instance->field(slot);
+            }
+
+            auto method = instance->klass()->find_method(expr->m_name.lexeme());
+            if (method.has_value())
+                expr->m_cache.update(instance->shape(), -1, nullptr, method.value());
+
+            return instance->get(expr->m_name);
+        }
+        case 5:
+        {
+            auto array = std::get<std::shared_ptr<Array>>(object.m_value.value());
+            if (expr->m_name == "length")
+                return static_cast<Value>(static_cast<double>(array->length()));
+
+            throw RuntimeError{expr->m_name, "Undefined property '" + expr->m_name.lexeme() + "'."};
+        }
+        case 6:
+        {
+            auto map = std::get<std::shared_ptr<Map>>(object.m_value.value());
+            if (expr->m_name == "size")
+                return static_cast<Value>(static_cast<double>(map->size()));
+
+            throw RuntimeError{expr->m_name, "Undefined property '" + expr->m_name.lexeme() + "'."};
+        }
+        case 7:
+        {
+            auto array = std::get<std::shared_ptr<Float64Array>>(object.m_value.value());
+            if (expr->m_name == "length")
+                return static_cast<Value>(static_cast<double>(array->length()));
+
+            throw RuntimeError{expr->m_name, "Undefined property '" + expr->m_name.lexeme() + "'."};
+        }
+        case 8:
+        {
+            auto records = std::get<std::shared_ptr<RecordArray>>(object.m_value.value());
+            if (expr->m_name == "length")
+                return static_cast<Value>(static_cast<double>(records->length()));
+
+            throw RuntimeError{expr->m_name, "Undefined property '" + expr->m_name.lexeme() + "'."};
+        }
+        case 9:
+        {
+            auto json = std::get<std::shared_ptr<LazyJson>>(object.m_value.value());
+            if (expr->m_name == "length")
+                return static_cast<Value>(static_cast<double>(json->length()));
+
+            throw RuntimeError{expr->m_name, "Undefined property '" + expr->m_name.lexeme() + "'."};
+        }
+        case 10:
+        {
+            auto builder = std::get<std::shared_ptr<StringBuilder>>(object.m_value.value());
+            if (expr->m_name == "length")
+                return static_cast<Value>(static_cast<double>(builder->length()));
+
+            throw RuntimeError{expr->m_name, "Undefined property '" + expr->m_name.lexeme() + "'."};
         }
         default:
             throw RuntimeError{expr->m_name, "Only instances and classes have properties."};
@@ -243,7 +364,44 @@ Value Interpreter::visit(expr::Set *expr)
     }
 
     Value value = evaluate(expr->m_value.get());
-    std::get<std::shared_ptr<Instance>>(object.m_value.value())->set(expr->m_name, value);
+    auto instance = std::get<std::shared_ptr<Instance>>(object.m_value.value());
+    if (instance->shape() == nullptr)
+    {
+        instance->set(expr->m_name, value);
+        return value;
+    }
+
+    // the shape is checked after evaluating the value, because the value might add fields to the instance
+    const InlineCache::Entry *entry = expr->m_cache.lookup(instance->shape().get());
+    if (entry != nullptr)
+    {
+        if (std::shared_ptr<Shape> transition = entry->m_transition.lock())
+            instance->add_field(transition, value);
+        else
+            instance->set_field(entry->m_slot, value);
+
+        return value;
+    }
+
+    std::shared_ptr<Shape> shape = instance->shape();
+    int slot = shape->lookup(expr->m_name.lexeme());
+    if (slot != -1)
+    {
+        expr->m_cache.update(shape, slot, nullptr, nullptr);
+        instance->set_field(slot, value);
+    }
+    else
+    {
+        if (shape->sealed())
+            throw RuntimeError{expr->m_name,
+                               "Record '" + instance->klass()->m_name + "' has no field '" + expr->m_name.lexeme() + "'."};
+
+        // cpplox allows creating new fields on instances
+        auto transition = shape->with_field(expr->m_name.lexeme());
+        expr->m_cache.update(shape, shape->size(), transition, nullptr);
+        instance->add_field(transition, value);
+    }
+
     return value;
 }
 
@@ -254,18 +412,265 @@ Value Interpreter::visit(expr::This *expr)
 
 Value Interpreter::visit(expr::Super *expr)
 {
-    int distance = m_locals.at(expr);
-    auto binding = m_env->get_at(distance, "super").m_value.value();
+    const LocalSlot &local = m_locals.at(expr);
+    auto binding = m_env->get_at(local.depth, local.slot).m_value.value();
     auto superclass = std::dynamic_pointer_cast<Class>(std::get<std::shared_ptr<Callable>>(binding));
-    auto object = std::get<std::shared_ptr<Instance>>(m_env->get_at(distance - 1, "this").m_value.value());
+    // `this` is the only variable in the scope right inside the `super` scope
+    auto object = std::get<std::shared_ptr<Instance>>(m_env->get_at(local.depth - 1, 0).m_value.value());
+
+    // the receiver's shape determines its class and thus the superclass `super` refers to
+    const InlineCache::Entry *entry = nullptr;
+    if (object->shape() != nullptr)
+        entry = expr->m_cache.lookup(object->shape().get());
+    if (entry != nullptr)
+        return std::dynamic_pointer_cast<Callable>(entry->m_method.lock()->bind(object));
 
     std::optional<std::shared_ptr<Function>> method = superclass->find_method(expr->m_method.lexeme());
     if (!method.has_value())
         throw RuntimeError{expr->m_method, "Undefined property '" + expr->m_method.lexeme() + "'."};
 
+    if (object->shape() != nullptr)
+        expr->m_cache.update(object->shape(), -1, nullptr, method.value());
+
     return std::dynamic_pointer_cast<Callable>(method.value()->bind(object));
 }
 
+Value Interpreter::visit(expr::Invoke *expr)
+{
+    bool is_tail_call = std::exchange(m_tail_position, false);
+    Value object = evaluate(expr->m_object.get());
+    if (!object.m_value.has_value())
+        throw RuntimeError{expr->m_name, "Only instances and classes have properties."};
+
+    switch (object.m_value->index())
+    {
+        case 3:
+        {
+            // Static method call
+            auto callable = std::get<std::shared_ptr<Callable>>(object.m_value.value());
+            auto klass = std::dynamic_pointer_cast<Class>(callable);
+            if (klass == nullptr)
+                throw RuntimeError{expr->m_name, "Only instances and classes have properties."};
+
+            auto method = klass->find_method(expr->m_name.lexeme());
+            if (!method.has_value())
+                throw RuntimeError{expr->m_name, "Undefined method '" + expr->m_name.lexeme() + "'."};
+            if (!method.value()->m_is_static)
+                throw RuntimeError{expr->m_name, "Only static methods can be called from a class."};
+
+            std::vector<Value> args = evaluate_args(expr->m_args);
+            check_arity(*method.value(), expr->m_paren, args);
+            return method.value()->call_method(this, klass, args);
+        }
+        case 4:
+        {
+            auto instance = std::get<std::shared_ptr<Instance>>(object.m_value.value());
+            if (instance->shape() == nullptr)
+            {
+                Value callee = instance->get(expr->m_name);
+                std::vector<Value> args = evaluate_args(expr->m_args);
+                return call_value(callee, expr->m_paren, args);
+            }
+
+            int slot = -1;
+            std::shared_ptr<Function> method;
+            const InlineCache::Entry *entry = expr->m_cache.lookup(instance->shape().get());
+            if (entry != nullptr)
+            {
+                slot = entry->m_slot;
+                method = entry->m_method.lock();
+            }
+            else
+            {
+                // slow path: fields shadow methods
+                slot = instance->shape()->lookup(expr->m_name.lexeme());
+                if (slot == -1)
+                {
+                    auto found = instance->klass()->find_method(expr->m_name.lexeme());
+                    if (!found.has_value())
+                        throw RuntimeError{expr->m_name, "Undefined property '" + expr->m_name.lexeme() + "'."};
+
+                    method = found.value();
+                }
+
+                expr->m_cache.update(instance->shape(), slot, nullptr, method);
+            }
+
+            if (slot != -1)
+            {
+                // a field holding something callable
+                Value callee = instance->field(slot);
+                std::vector<Value> args = evaluate_args(expr->m_args);
+                return call_value(callee, expr->m_paren, args);
+            }
+
+            if (method->arity() != expr->m_args.size())
+            {
+                std::vector<Value> args = evaluate_args(expr->m_args);
+                check_arity(*method, expr->m_paren, args);
+            }
+
+            auto frame = method->new_method_frame(instance);
+            for (const auto &arg : expr->m_args)
+            {
+                frame->define(evaluate(arg.get()));
+            }
+
+            if (is_tail_call)
+            {
+                m_tail_call = TailCall{method, frame};
+                return std::nullopt;
+            }
+
+            return method->run(this, std::move(frame));
+        }
+        case 5:
+        {
+            auto array = std::get<std::shared_ptr<Array>>(object.m_value.value());
+            check_native_method(Array::method_arity(expr->m_name.lexeme()), expr);
+
+            if (array->fixed_length())
+                throw RuntimeError{expr->m_name, "Can't change the length of a RecordArray column."};
+
+            // the argument is evaluated straight into the array
+            if (expr->m_name == "push")
+            {
+                array->push(evaluate(expr->m_args[0].get()));
+                return std::nullopt;
+            }
+
+            return array->pop(expr->m_name);
+        }
+        case 6:
+        {
+            auto map = std::get<std::shared_ptr<Map>>(object.m_value.value());
+            check_native_method(Map::method_arity(expr->m_name.lexeme()), expr);
+
+            if (expr->m_name == "keys")
+                return map->keys();
+            if (expr->m_name == "values")
+                return map->values();
+
+            Value key = evaluate(expr->m_args[0].get());
+            if (expr->m_name == "has")
+                return static_cast<Value>(map->has(key, expr->m_paren));
+            return static_cast<Value>(map->remove(key, expr->m_paren));
+        }
+        case 7:
+        {
+            auto array = std::get<std::shared_ptr<Float64Array>>(object.m_value.value());
+            check_native_method(Float64Array::method_arity(expr->m_name.lexeme()), expr);
+
+            return array->call_method(expr->m_name, expr->m_paren, evaluate_args(expr->m_args));
+        }
+        case 8:
+        {
+            auto records = std::get<std::shared_ptr<RecordArray>>(object.m_value.value());
+            check_native_method(RecordArray::method_arity(expr->m_name.lexeme()), expr);
+
+            Value arg = evaluate(expr->m_args[0].get());
+            if (expr->m_name == "column")
+                return records->column(arg, expr->m_paren);
+
+            records->push(arg, expr->m_paren);
+            return std::nullopt;
+        }
+        case 9:
+        {
+            auto json = std::get<std::shared_ptr<LazyJson>>(object.m_value.value());
+            check_native_method(LazyJson::method_arity(expr->m_name.lexeme()), expr);
+
+            return json->call_method(expr->m_name, expr->m_paren, evaluate_args(expr->m_args));
+        }
+        case 10:
+        {
+            auto builder = std::get<std::shared_ptr<StringBuilder>>(object.m_value.value());
+            check_native_method(StringBuilder::method_arity(expr->m_name.lexeme()), expr);
+
+            // the argument is evaluated straight into the builder
+            if (expr->m_name == "append")
+            {
+                builder->append(evaluate(expr->m_args[0].get()));
+                return builder;
+            }
+
+            return builder->call_method(expr->m_name, expr->m_paren, evaluate_args(expr->m_args));
+        }
+        default:
+            throw RuntimeError{expr->m_name, "Only instances and classes have properties."};
+    }
+}
+
+Value Interpreter::visit(expr::ArrayLiteral *expr)
+{
+    std::vector<Value> elements;
+    elements.reserve(expr->m_elements.size());
+    for (const auto &element : expr->m_elements)
+    {
+        elements.emplace_back(evaluate(element.get()));
+    }
+
+    return Array::create(std::move(elements));
+}
+
+Value Interpreter::visit(expr::Subscript *expr)
+{
+    Value object = evaluate(expr->m_object.get());
+    Value index = evaluate(expr->m_index.get());
+    if (object.m_value.has_value())
+    {
+        if (auto array = std::get_if<std::shared_ptr<Array>>(&object.m_value.value()))
+            return (*array)->get(index, expr->m_bracket);
+        if (auto map = std::get_if<std::shared_ptr<Map>>(&object.m_value.value()))
+            return (*map)->get(index, expr->m_bracket);
+        if (auto array = std::get_if<std::shared_ptr<Float64Array>>(&object.m_value.value()))
+            return (*array)->get(index, expr->m_bracket);
+        if (auto records = std::get_if<std::shared_ptr<RecordArray>>(&object.m_value.value()))
+            return (*records)->get(index, expr->m_bracket);
+        if (auto json = std::get_if<std::shared_ptr<LazyJson>>(&object.m_value.value()))
+            return (*json)->get(index, expr->m_bracket);
+    }
+
+    throw RuntimeError{expr->m_bracket, "Only arrays and maps can be indexed."};
+}
+
+Value Interpreter::visit(expr::SetSubscript *expr)
+{
+    Value object = evaluate(expr->m_object.get());
+    Value index = evaluate(expr->m_index.get());
+    if (object.m_value.has_value())
+    {
+        if (auto array = std::get_if<std::shared_ptr<Array>>(&object.m_value.value()))
+        {
+            Value value = evaluate(expr->m_value.get());
+            (*array)->set(index, expr->m_bracket, value);
+            return value;
+        }
+        if (auto map = std::get_if<std::shared_ptr<Map>>(&object.m_value.value()))
+        {
+            Value value = evaluate(expr->m_value.get());
+            (*map)->set(index, expr->m_bracket, value);
+            return value;
+        }
+        if (auto array = std::get_if<std::shared_ptr<Float64Array>>(&object.m_value.value()))
+        {
+            Value value = evaluate(expr->m_value.get());
+            (*array)->set(index, expr->m_bracket, value);
+            return value;
+        }
+        if (auto records = std::get_if<std::shared_ptr<RecordArray>>(&object.m_value.value()))
+        {
+            Value value = evaluate(expr->m_value.get());
+            (*records)->set(index, expr->m_bracket, value);
+            return value;
+        }
+        if (std::holds_alternative<std::shared_ptr<LazyJson>>(object.m_value.value()))
+            throw RuntimeError{expr->m_bracket, "Lazy JSON values can't be changed. Use 'materialize()' first."};
+    }
+
+    throw RuntimeError{expr->m_bracket, "Only arrays and maps can be indexed."};
+}
+
 void Interpreter::visit(stmt::Expression *stmt)
 {
     evaluate(stmt->m_expr.get());
@@ -274,8 +679,7 @@ void Interpreter::visit(stmt::Expression *stmt)
 void Interpreter::visit(stmt::Print *stmt)
 {
     Value value = evaluate(stmt->m_expr.get());
-    // TODO: provide formatter<T> specialization, which will allow me to use fmt::print
-    std::cout << value;
+    Output::write(value);
 }
 
 void Interpreter::visit(stmt::Var *stmt)
@@ -291,16 +695,100 @@ void Interpreter::visit(stmt::Var *stmt)
 
 void Interpreter::visit(stmt::Block *stmt)
 {
-    /* TODO: there is a leak here. I throw an exception in `execute_block()`
-        and we never get back here to free `env`
-    */
-    auto env = std::make_shared<Environment>(m_env);
+    auto env = Environment::create(m_env, stmt->m_slots);
     execute_block(stmt->m_statements, env);
 }
 
+Value Interpreter::visit(expr::UpdateLocal *expr)
+{
+    Value current = m_env->get_at(expr->m_depth, expr->m_slot);
+    Value operand = expr->m_constant.has_value() ? expr->m_constant.value() : evaluate(expr->m_binary->m_right.get());
+    Value result = binary(expr->m_binary.get(), current, operand);
+
+    m_env->assign_at(expr->m_depth, expr->m_slot, result);
+    return result;
+}
+
+Value Interpreter::visit(expr::CompareLocals *expr)
+{
+    return static_cast<Value>(compare(expr));
+}
+
+bool Interpreter::compare(expr::CompareLocals *expr)
+{
+    const Value &left = expr->m_left.m_depth == -1 ? expr->m_left.m_constant
+                                                   : m_env->get_at(expr->m_left.m_depth, expr->m_left.m_slot);
+    const Value &right = expr->m_right.m_depth == -1 ? expr->m_right.m_constant
+                                                     : m_env->get_at(expr->m_right.m_depth, expr->m_right.m_slot);
+
+    auto dleft = left.m_value.has_value() ? std::get_if<double>(&left.m_value.value()) : nullptr;
+    auto dright = right.m_value.has_value() ? std::get_if<double>(&right.m_value.value()) : nullptr;
+    if (dleft != nullptr && dright != nullptr)
+    {
+        switch (expr->m_binary->m_op.token_type())
+        {
+            case TokenType::GREATER:
+                return *dleft > *dright;
+            case TokenType::GREATER_EQUAL:
+                return *dleft >= *dright;
+            case TokenType::LESS:
+                return *dleft < *dright;
+            case TokenType::LESS_EQUAL:
+                return *dleft <= *dright;
+            case TokenType::EQUAL_EQUAL:
+                return *dleft == *dright;
+            case TokenType::BANG_EQUAL:
+                return *dleft != *dright;
+            default:
+                break;
+        }
+    }
+
+    return is_true(binary(expr->m_binary.get(), left, right));
+}
+
+Value Interpreter::visit(expr::UpdateField *expr)
+{
+    const Value &object = m_env->get_at(expr->m_depth, expr->m_slot);
+    auto instance_ptr = object.m_value.has_value() ? std::get_if<std::shared_ptr<Instance>>(&object.m_value.value())
+                                                   : nullptr;
+    if (instance_ptr != nullptr && (*instance_ptr)->shape() != nullptr)
+    {
+        // keeps the instance alive even if evaluating the operand reassigns the variable
+        std::shared_ptr<Instance> instance = *instance_ptr;
+
+        int slot;
+        const InlineCache::Entry *entry = expr->m_cache.lookup(instance->shape().get());
+        if (entry != nullptr)
+            slot = entry->m_slot;
+        else
+        {
+            slot = instance->shape()->lookup(expr->m_set->m_name.lexeme());
+            if (slot != -1)
+                expr->m_cache.update(instance->shape(), slot, nullptr, nullptr);
+        }
+
+        // slots stay valid even if the operand adds fields to the instance
+        if (slot != -1)
+        {
+            Value current = instance->field(slot);
+            Value operand = evaluate(expr->m_binary->m_right.get());
+            Value result = binary(expr->m_binary.get(), current, operand);
+
+            instance->set_field(slot, result);
+            return result;
+        }
+    }
+
+    // methods, classes and errors. Reading `object` twice is fine - it's a variable
+    return evaluate(expr->m_set.get());
+}
+
 void Interpreter::visit(stmt::If *stmt)
 {
-    if (is_true(evaluate(stmt->m_condition.get())))
+    bool condition = stmt->m_fused_condition != nullptr ? compare(stmt->m_fused_condition)
+                                                        : is_true(evaluate(stmt->m_condition.get()));
+    if (condition)
     {
         execute(stmt->m_then.get());
     }
@@ -312,9 +800,19 @@ void Interpreter::visit(stmt::If *stmt)
 
 void Interpreter::visit(stmt::While *stmt)
 {
-    while (is_true(evaluate(stmt->m_condition.get())))
+    while (stmt->m_fused_condition != nullptr ? compare(stmt->m_fused_condition)
+                                              : is_true(evaluate(stmt->m_condition.get())))
     {
         execute(stmt->m_stmt.get());
+        if (m_returning)
+            break;
+
+        if (m_loop_counter != nullptr)
+            (*m_loop_counter)++;
+
+        // a long loop continues as compiled code from its next iteration
+        if (Jit::enabled() && Jit::run_loop(*this, stmt, *m_env))
+            break;
     }
 }
 
@@ -329,11 +827,18 @@ void Interpreter::visit(stmt::Return *stmt)
 {
     Value value = std::nullopt;
     if (stmt->m_value.has_value())
+    {
+        // a call to a user-defined function doesn't happen here,
+        // it's left in `m_tail_call` for the returning function to run
+        m_tail_position = stmt->m_is_tail_call;
         value = evaluate(stmt->m_value->get());
+        m_tail_position = false;
+    }
 
-    // using exceptions for returning from functions is fucking horrible,
-    // but I couldn't come up with anything else
-    throw Return{value};
+    // the enclosing blocks and loops see the flag and stop,
+    // the function being returned from picks up the value
+    m_return_value = value;
+    m_returning = true;
 }
 
 void Interpreter::visit(stmt::Class *stmt)
@@ -353,14 +858,18 @@ void Interpreter::visit(stmt::Class *stmt)
             {
                 throw RuntimeError{stmt->m_super.value()->m_name, "Superclass must be a class."};
             }
+            if ((*superclass)->is_record())
+            {
+                throw RuntimeError{stmt->m_super.value()->m_name, "Can't inherit from a record."};
+            }
         }
     }
 
-    m_env->define(stmt->m_name.lexeme(), std::nullopt);
+    int slot = m_env->define(stmt->m_name.lexeme(), std::nullopt);
 
     if (super_exists)
     {
-        m_env = std::make_shared<Environment>(m_env);
+        m_env = Environment::create(m_env, 1);
         m_env->define("super", superclass_value);
     }
 
@@ -375,12 +884,25 @@ void Interpreter::visit(stmt::Class *stmt)
         methods.emplace(method->m_name.lexeme(), function);
     }
 
-    auto klass = std::make_shared<Class>(stmt->m_name.lexeme(), superclass, methods);
+    std::optional<std::vector<std::string>> fields = std::nullopt;
+    if (stmt->m_fields.has_value())
+    {
+        fields.emplace();
+        for (const Token &field : stmt->m_fields.value())
+        {
+            fields->push_back(field.lexeme());
+        }
+    }
+
+    auto klass = std::make_shared<Class>(stmt->m_name.lexeme(), superclass, methods, fields);
 
     if (super_exists)
         m_env = m_env->m_enclosing;
 
-    m_env->assign(stmt->m_name, std::dynamic_pointer_cast<Callable>(klass));
+    if (slot == -1)
+        m_env->assign(stmt->m_name, std::dynamic_pointer_cast<Callable>(klass));
+    else
+        m_env->assign_at(0, slot, std::dynamic_pointer_cast<Callable>(klass));
 }
 
 void Interpreter::visit(stmt::Import *stmt)
@@ -402,6 +924,8 @@ void Interpreter::execute_block(const std::vector<StatementPtr> &statements, con
         for (auto &statement : statements)
         {
             execute(statement.get());
+            if (m_returning)
+                break;
         }
     }
     catch (...)
@@ -413,9 +937,31 @@ void Interpreter::execute_block(const std::vector<StatementPtr> &statements, con
     m_env = previous;
 }
 
-void Interpreter::resolve(expr::Expression *expr, int depth)
+void Interpreter::resolve(expr::Expression *expr, int depth, int slot)
+{
+    m_locals.emplace(expr, LocalSlot{depth, slot});
+}
+
+std::optional<TailCall> Interpreter::take_tail_call()
+{
+    if (!m_tail_call.has_value())
+        return std::nullopt;
+
+    // the `return` that made the call is done
+    m_returning = false;
+    m_return_value = std::nullopt;
+    return std::exchange(m_tail_call, std::nullopt);
+}
+
+Value Interpreter::take_return_value()
 {
-    m_locals.emplace(expr, depth);
+    if (!m_returning)
+        return std::nullopt;
+
+    m_returning = false;
+    Value value = std::move(m_return_value);
+    m_return_value = std::nullopt;
+    return value;
 }
 
 Value Interpreter::evaluate(expr::Expression *expr)
@@ -429,21 +975,81 @@ void Interpreter::execute(stmt::Statement *stmt)
     if (stmt == nullptr)
         return;
 
+    // statement boundaries are safe points - every object is fully constructed here
+    if (GarbageCollector::should_collect())
+        GarbageCollector::collect();
+
     stmt->accept(this);
 }
 
-Value Interpreter::lookup_variable(const Token &name, expr::Expression *expr)
+std::vector<Value> Interpreter::evaluate_args(const std::vector<ExpressionPtr> &args)
 {
-    auto distance = m_locals.find(expr);
+    std::vector<Value> values;
+    values.reserve(args.size());
+    for (const auto &arg : args)
+    {
+        values.emplace_back(evaluate(arg.get()));
+    }
 
-    Value val = std::nullopt;
-    if (distance != m_locals.end())
-        val = m_env->get_at(distance->second, name.lexeme());
-    else
-        val = m_globals->get(name);
+    return values;
+}
+
+Value Interpreter::call_value(const Value &callee, const Token &paren, const std::vector<Value> &args)
+{
+    // check if the `callee` is actually something we can call
+    if (!callee.m_value.has_value() || !std::holds_alternative<std::shared_ptr<Callable>>(callee.m_value.value()))
+    {
+        throw RuntimeError{paren, "Can only call functions and classes."};
+    }
+
+    auto function = std::get<std::shared_ptr<Callable>>(callee.m_value.value());
+    check_arity(*function, paren, args);
+
+    try
+    {
+        return function->call(this, args);
+    }
+    catch (NativeError &e)
+    {
+        throw RuntimeError{paren, e.m_msg};
+    }
+}
+
+void Interpreter::check_arity(const Callable &callable, const Token &paren, const std::vector<Value> &args)
+{
+    if (args.size() != callable.arity())
+    {
+        throw RuntimeError{paren, "Expected " + std::to_string(callable.arity()) + " arguments, but got " +
+                                      std::to_string(args.size()) + "."};
+    }
+}
+
+void Interpreter::check_native_method(int arity, expr::Invoke *expr)
+{
+    if (arity == -1)
+        throw RuntimeError{expr->m_name, "Undefined method '" + expr->m_name.lexeme() + "'."};
+    if (static_cast<std::size_t>(arity) != expr->m_args.size())
+        throw RuntimeError{expr->m_paren, "Expected " + std::to_string(arity) + " arguments, but got " +
+                                              std::to_string(expr->m_args.size()) + "."};
+}
+
+std::optional<LocalSlot> Interpreter::local_slot(expr::Expression *expr) const
+{
+    auto local = m_locals.find(expr);
+    if (local == m_locals.end())
+        return std::nullopt;
+
+    return local->second;
+}
+
+Value Interpreter::lookup_variable(const Token &name, expr::Expression *expr)
+{
+    auto local = m_locals.find(expr);
+    if (local != m_locals.end())
+        return m_env->get_at(local->second.depth, local->second.slot);
 
     // check_null(val, name);
-    return val;
+    return m_globals->get(name);
 }
 
 void Interpreter::check_null(const Value &value, const Token &name)
@@ -465,6 +1071,106 @@ void Interpreter::register_native_funcs()
     // println()
     auto println = std::make_shared<PrintlnFunction>();
     m_globals->define("println", std::dynamic_pointer_cast<Callable>(println));
+
+    // memory_usage()
+    auto memory_usage = std::make_shared<MemoryUsageFunction>();
+    m_globals->define("memory_usage", std::dynamic_pointer_cast<Callable>(memory_usage));
+
+    // flush()
+    auto flush = std::make_shared<FlushFunction>();
+    m_globals->define("flush", std::dynamic_pointer_cast<Callable>(flush));
+
+    // read_file()
+    auto read_file = std::make_shared<ReadFileFunction>();
+    m_globals->define("read_file", std::dynamic_pointer_cast<Callable>(read_file));
+
+    // open_lines()
+    auto open_lines = std::make_shared<OpenLinesFunction>();
+    m_globals->define("open_lines", std::dynamic_pointer_cast<Callable>(open_lines));
+
+    // next_line()
+    auto next_line = std::make_shared<NextLineFunction>();
+    m_globals->define("next_line", std::dynamic_pointer_cast<Callable>(next_line));
+
+    // read_csv()
+    auto read_csv = std::make_shared<ReadCsvFunction>();
+    m_globals->define("read_csv", std::dynamic_pointer_cast<Callable>(read_csv));
+
+    // json_parse()
+    auto json_parse = std::make_shared<JsonParseFunction>();
+    m_globals->define("json_parse", std::dynamic_pointer_cast<Callable>(json_parse));
+
+    // json_parse_lazy()
+    auto json_parse_lazy = std::make_shared<JsonParseLazyFunction>();
+    m_globals->define("json_parse_lazy", std::dynamic_pointer_cast<Callable>(json_parse_lazy));
+
+    // json_stringify()
+    auto json_stringify = std::make_shared<JsonStringifyFunction>();
+    m_globals->define("json_stringify", std::dynamic_pointer_cast<Callable>(json_stringify));
+
+    // json_write()
+    auto json_write = std::make_shared<JsonWriteFunction>();
+    m_globals->define("json_write", std::dynamic_pointer_cast<Callable>(json_write));
+
+    // StringBuilder()
+    auto string_builder = std::make_shared<StringBuilderFunction>();
+    m_globals->define("StringBuilder", std::dynamic_pointer_cast<Callable>(string_builder));
+
+    // Array()
+    auto array = std::make_shared<ArrayFunction>();
+    m_globals->define("Array", std::dynamic_pointer_cast<Callable>(array));
+
+    // Map()
+    auto map = std::make_shared<MapFunction>();
+    m_globals->define("Map", std::dynamic_pointer_cast<Callable>(map));
+
+    // Float64Array()
+    auto float64_array = std::make_shared<Float64ArrayFunction>();
+    m_globals->define("Float64Array", std::dynamic_pointer_cast<Callable>(float64_array));
+
+    // RecordArray()
+    auto record_array = std::make_shared<RecordArrayFunction>();
+    m_globals->define("RecordArray", std::dynamic_pointer_cast<Callable>(record_array));
+}
+
+bool Interpreter::import_native_module(std::string_view name)
+{
+    if (name != "strings")
+        return false;
+
+    // find()
+    auto find = std::make_shared<FindFunction>();
+    m_globals->define("find", std::dynamic_pointer_cast<Callable>(find));
+
+    // contains()
+    auto contains = std::make_shared<ContainsFunction>();
+    m_globals->define("contains", std::dynamic_pointer_cast<Callable>(contains));
+
+    // starts_with()
+    auto starts_with = std::make_shared<StartsWithFunction>();
+    m_globals->define("starts_with", std::dynamic_pointer_cast<Callable>(starts_with));
+
+    // split()
+    auto split = std::make_shared<SplitFunction>();
+    m_globals->define("split", std::dynamic_pointer_cast<Callable>(split));
+
+    // join()
+    auto join = std::make_shared<JoinFunction>();
+    m_globals->define("join", std::dynamic_pointer_cast<Callable>(join));
+
+    // replace()
+    auto replace = std::make_shared<ReplaceFunction>();
+    m_globals->define("replace", std::dynamic_pointer_cast<Callable>(replace));
+
+    // substr()
+    auto substr = std::make_shared<SubstrFunction>();
+    m_globals->define("substr", std::dynamic_pointer_cast<Callable>(substr));
+
+    // char_code()
+    auto char_code = std::make_shared<CharCodeFunction>();
+    m_globals->define("char_code", std::dynamic_pointer_cast<Callable>(char_code));
+
+    return true;
 }
 
 bool Interpreter::is_true(const Value &val)
@@ -487,9 +1193,26 @@ bool Interpreter::is_equal(const Value &val1, const Value &val2)
     if (!val1.m_value.has_value() || !val2.m_value.has_value())
         return false;
 
+    // strings are different objects even when their texts are equal
+    auto str1 = std::get_if<std::shared_ptr<String>>(&val1.m_value.value());
+    auto str2 = std::get_if<std::shared_ptr<String>>(&val2.m_value.value());
+    if (str1 != nullptr && str2 != nullptr)
+        return (*str1)->equals(**str2);
+
     return val1.m_value.value() == val2.m_value.value();
 }
 
+std::shared_ptr<String> Interpreter::to_string_object(const Value &val)
+{
+    if (auto str = std::get_if<std::shared_ptr<String>>(&val.m_value.value()))
+        return *str;
+
+    NumberBuffer buffer;
+    std::string storage;
+    std::string_view text = val.text(buffer, storage);
+    return String::create(text.data() == storage.data() ? std::move(storage) : std::string{text});
+}
+
 void Interpreter::check_number_operands(const Token &op, const Value &operand)
 {
     if (std::holds_alternative<double>(operand.m_value.value()))
@@ -0,0 +1,213 @@
+#include "jit/assembler.h"
+
+namespace cpplox::jit
+{
+void Assembler::push(Gp reg)
+{
+    emit(0x50 + static_cast<int>(reg));
+}
+
+void Assembler::pop(Gp reg)
+{
+    emit(0x58 + static_cast<int>(reg));
+}
+
+void Assembler::ret()
+{
+    emit(0xC3);
+}
+
+void Assembler::mov(Gp dst, Gp src)
+{
+    rex_w(static_cast<int>(src), static_cast<int>(dst));
+    emit(0x89);
+    modrm(static_cast<int>(src), static_cast<int>(dst));
+}
+
+void Assembler::mov(Gp dst, uint64_t imm)
+{
+    rex_w(0, static_cast<int>(dst));
+    emit(0xB8 + static_cast<int>(dst));
+    emit64(imm);
+}
+
+void Assembler::mov32(Gp dst, int32_t imm)
+{
+    emit(0xB8 + static_cast<int>(dst));
+    emit32(imm);
+}
+
+void Assembler::add(Gp dst, int32_t imm)
+{
+    rex_w(0, static_cast<int>(dst));
+    emit(0x81);
+    modrm(0, static_cast<int>(dst));
+    emit32(imm);
+}
+
+void Assembler::sub(Gp dst, int32_t imm)
+{
+    rex_w(5, static_cast<int>(dst));
+    emit(0x81);
+    modrm(5, static_cast<int>(dst));
+    emit32(imm);
+}
+
+void Assembler::movq(Xmm dst, Gp src)
+{
+    // the operand size prefix goes before REX
+    emit(0x66);
+    rex_w(static_cast<int>(dst), static_cast<int>(src));
+    emit(0x0F);
+    emit(0x6E);
+    modrm(static_cast<int>(dst), static_cast<int>(src));
+}
+
+void Assembler::movsd(Xmm dst, Memory src)
+{
+    emit(0xF2);
+    emit(0x0F);
+    emit(0x10);
+    modrm(static_cast<int>(dst), src);
+}
+
+void Assembler::movsd(Memory dst, Xmm src)
+{
+    emit(0xF2);
+    emit(0x0F);
+    emit(0x11);
+    modrm(static_cast<int>(src), dst);
+}
+
+void Assembler::movapd(Xmm dst, Xmm src)
+{
+    sse(0x66, 0x28, dst, src);
+}
+
+void Assembler::addsd(Xmm dst, Xmm src)
+{
+    sse(0xF2, 0x58, dst, src);
+}
+
+void Assembler::subsd(Xmm dst, Xmm src)
+{
+    sse(0xF2, 0x5C, dst, src);
+}
+
+void Assembler::mulsd(Xmm dst, Xmm src)
+{
+    sse(0xF2, 0x59, dst, src);
+}
+
+void Assembler::divsd(Xmm dst, Xmm src)
+{
+    sse(0xF2, 0x5E, dst, src);
+}
+
+void Assembler::xorpd(Xmm dst, Xmm src)
+{
+    sse(0x66, 0x57, dst, src);
+}
+
+void Assembler::ucomisd(Xmm left, Xmm right)
+{
+    sse(0x66, 0x2E, left, right);
+}
+
+Label Assembler::new_label()
+{
+    m_labels.push_back(-1);
+    return Label{static_cast<int>(m_labels.size()) - 1};
+}
+
+void Assembler::bind(Label label)
+{
+    m_labels[label.id] = m_code.size();
+}
+
+void Assembler::jmp(Label label)
+{
+    emit(0xE9);
+    fixup(label);
+}
+
+void Assembler::j(Condition condition, Label label)
+{
+    emit(0x0F);
+    emit(0x80 + static_cast<int>(condition));
+    fixup(label);
+}
+
+std::vector<uint8_t> Assembler::finish()
+{
+    for (const Fixup& fixup : m_fixups)
+    {
+        // offsets are relative to the end of the jump, which is where the placeholder ends
+        uint32_t offset = m_labels[fixup.label] - (fixup.position + 4);
+        for (int i = 0; i < 4; i++)
+        {
+            m_code[fixup.position + i] = (offset >> (i * 8)) & 0xFF;
+        }
+    }
+    m_fixups.clear();
+
+    return m_code;
+}
+
+void Assembler::emit(uint8_t byte)
+{
+    m_code.push_back(byte);
+}
+
+void Assembler::emit32(uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        emit((value >> (i * 8)) & 0xFF);
+    }
+}
+
+void Assembler::emit64(uint64_t value)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        emit((value >> (i * 8)) & 0xFF);
+    }
+}
+
+void Assembler::rex_w(int reg, int rm)
+{
+    emit(0x48 | ((reg >> 3) << 2) | (rm >> 3));
+}
+
+void Assembler::modrm(int reg, int rm)
+{
+    emit(0xC0 | ((reg & 7) << 3) | (rm & 7));
+}
+
+void Assembler::modrm(int reg, Memory memory)
+{
+    int base = static_cast<int>(memory.base);
+    // [base + disp32]
+    emit(0x80 | ((reg & 7) << 3) | (base & 7));
+    // `rsp` as a base can only be encoded with a SIB byte
+    if ((base & 7) == static_cast<int>(Gp::RSP))
+        emit(0x24);
+    emit32(memory.disp);
+}
+
+void Assembler::sse(uint8_t prefix, uint8_t opcode, Xmm dst, Xmm src)
+{
+    emit(prefix);
+    emit(0x0F);
+    emit(opcode);
+    modrm(static_cast<int>(dst), static_cast<int>(src));
+}
+
+void Assembler::fixup(Label label)
+{
+    m_fixups.push_back({static_cast<int>(m_code.size()), label.id});
+    emit32(0);
+}
+
+}
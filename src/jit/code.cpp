@@ -0,0 +1,32 @@
+#include "jit/code.h"
+
+#include <cstring>
+
+#include <sys/mman.h>
+
+namespace cpplox::jit
+{
+std::shared_ptr<Code> Code::create(const std::vector<uint8_t>& bytes, int locals, std::vector<Binding> bindings)
+{
+    void* memory = mmap(nullptr, bytes.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+        return nullptr;
+
+    std::memcpy(memory, bytes.data(), bytes.size());
+
+    // the mapping is never writable and executable at the same time
+    if (mprotect(memory, bytes.size(), PROT_READ | PROT_EXEC) != 0)
+    {
+        munmap(memory, bytes.size());
+        return nullptr;
+    }
+
+    return std::make_shared<Code>(memory, bytes.size(), locals, std::move(bindings));
+}
+
+Code::~Code()
+{
+    munmap(m_memory, m_size);
+}
+
+}
@@ -0,0 +1,617 @@
+#include "jit/compiler.h"
+
+#include <bit>
+
+namespace cpplox::jit
+{
+std::shared_ptr<Code> Compiler::compile(stmt::Function* declaration)
+{
+    begin();
+
+    // the function's own scope holds the arguments
+    m_scopes.push_back(0);
+    m_defined.push_back(declaration->m_params.size());
+    m_locals = declaration->m_slots;
+
+    try
+    {
+        compile(declaration->m_body);
+    }
+    catch (const Unsupported&)
+    {
+        return nullptr;
+    }
+
+    return finish();
+}
+
+std::shared_ptr<Code> Compiler::compile(stmt::While* loop)
+{
+    m_loop = loop;
+    begin();
+
+    try
+    {
+        compile_loop(loop, true);
+    }
+    catch (const Unsupported&)
+    {
+        return nullptr;
+    }
+
+    return finish();
+}
+
+void Compiler::begin()
+{
+    m_exit = m_asm.new_label();
+    m_deoptimize = m_asm.new_label();
+    m_save = m_asm.new_label();
+    m_saved = m_asm.new_label();
+
+    m_asm.push(Gp::RBP);
+    m_asm.mov(Gp::RBP, Gp::RSP);
+}
+
+std::shared_ptr<Code> Compiler::finish()
+{
+    // running off the end returns nil
+    m_asm.mov32(Gp::RAX, static_cast<int32_t>(Status::RETURNED_NIL));
+    m_asm.jmp(m_exit);
+
+    m_asm.bind(m_deoptimize);
+    m_asm.mov32(Gp::RAX, static_cast<int32_t>(Status::DEOPTIMIZED));
+
+    // restoring rsp from rbp drops whatever expressions spilled when leaving from the middle of one
+    m_asm.bind(m_exit);
+    m_asm.mov(Gp::RSP, Gp::RBP);
+    m_asm.pop(Gp::RBP);
+    m_asm.ret();
+
+    if (m_loop != nullptr)
+    {
+        // only now is it known which bindings the loop assigns
+        m_asm.bind(m_save);
+        for (Binding& binding : m_bindings)
+        {
+            if (binding.m_saved == -1)
+                continue;
+
+            binding.m_saved = m_locals++;
+            m_asm.movsd(Xmm::XMM0, Memory{Gp::RDI, binding.m_local * 8});
+            m_asm.movsd(Memory{Gp::RDI, binding.m_saved * 8}, Xmm::XMM0);
+        }
+        m_asm.jmp(m_saved);
+    }
+
+    return Code::create(m_asm.finish(), m_locals, std::move(m_bindings));
+}
+
+void Compiler::visit(stmt::Block* stmt)
+{
+    // every block gets its own part of the locals array, so nothing has to be cleared between scopes
+    m_scopes.push_back(m_locals);
+    m_defined.push_back(0);
+    m_locals += stmt->m_slots;
+
+    compile(stmt->m_statements);
+
+    m_scopes.pop_back();
+    m_defined.pop_back();
+}
+
+void Compiler::visit(stmt::Var* stmt)
+{
+    // an uninitialized variable is nil. A loop's body is a block if it declares anything.
+    if (!stmt->m_initializer.has_value() || m_scopes.empty())
+        throw Unsupported{};
+
+    compile(stmt->m_initializer->get());
+
+    int slot = m_defined.back()++;
+    store(Memory{Gp::RDI, (m_scopes.back() + slot) * 8});
+}
+
+void Compiler::visit(stmt::Function*)
+{
+    throw Unsupported{};
+}
+
+void Compiler::visit(stmt::Expression* stmt)
+{
+    compile(stmt->m_expr.get());
+}
+
+void Compiler::visit(stmt::If* stmt)
+{
+    Label otherwise = m_asm.new_label();
+    Label end = m_asm.new_label();
+
+    branch(stmt->m_condition.get(), otherwise, false);
+    stmt->m_then->accept(this);
+
+    if (stmt->m_else.has_value())
+    {
+        m_asm.jmp(end);
+        m_asm.bind(otherwise);
+        stmt->m_else.value()->accept(this);
+    }
+    else
+        m_asm.bind(otherwise);
+
+    m_asm.bind(end);
+}
+
+void Compiler::visit(stmt::Print*)
+{
+    throw Unsupported{};
+}
+
+void Compiler::visit(stmt::Return* stmt)
+{
+    // the interpreter has no way to pick up a return from a loop
+    if (m_loop != nullptr)
+        throw Unsupported{};
+
+    if (!stmt->m_value.has_value())
+    {
+        leave(Status::RETURNED_NIL);
+        return;
+    }
+
+    compile(stmt->m_value->get());
+    m_asm.movsd(Memory{Gp::RSI, 0}, Xmm::XMM0);
+    leave(Status::RETURNED_NUMBER);
+}
+
+void Compiler::visit(stmt::While* stmt)
+{
+    compile_loop(stmt, false);
+}
+
+void Compiler::visit(stmt::Class*)
+{
+    throw Unsupported{};
+}
+
+void Compiler::visit(stmt::Import*)
+{
+    throw Unsupported{};
+}
+
+Value Compiler::visit(expr::Variable* expr)
+{
+    m_asm.movsd(Xmm::XMM0, local(expr, expr->m_name));
+    return std::nullopt;
+}
+
+Value Compiler::visit(expr::Assign* expr)
+{
+    compile(expr->m_value.get());
+    store(local(expr, expr->m_name));
+    return std::nullopt;
+}
+
+Value Compiler::visit(expr::Lambda*)
+{
+    throw Unsupported{};
+}
+
+Value Compiler::visit(expr::Binary* expr)
+{
+    // comparisons make booleans, which are only supported as conditions
+    switch (expr->m_op.token_type())
+    {
+        case TokenType::PLUS:
+        case TokenType::MINUS:
+        case TokenType::STAR:
+        case TokenType::SLASH:
+            break;
+        default:
+            throw Unsupported{};
+    }
+
+    compile(expr->m_left.get());
+    load_right(expr->m_right.get());
+    arithmetic(expr->m_op);
+    return std::nullopt;
+}
+
+Value Compiler::visit(expr::Call*)
+{
+    throw Unsupported{};
+}
+
+Value Compiler::visit(expr::Grouping* expr)
+{
+    compile(expr->m_expression.get());
+    return std::nullopt;
+}
+
+Value Compiler::visit(expr::Literal* expr)
+{
+    const Value& value = *expr->m_value;
+    auto number = value.m_value.has_value() ? std::get_if<double>(&value.m_value.value()) : nullptr;
+    if (number == nullptr)
+        throw Unsupported{};
+
+    load_constant(*number, Xmm::XMM0);
+    return std::nullopt;
+}
+
+Value Compiler::visit(expr::Logical*)
+{
+    // `and` and `or` return one of their operands, which may be a boolean
+    throw Unsupported{};
+}
+
+Value Compiler::visit(expr::Unary* expr)
+{
+    if (expr->m_op.token_type() != TokenType::MINUS)
+        throw Unsupported{};
+
+    compile(expr->m_right.get());
+    // flip the sign bit
+    load_constant(-0.0, Xmm::XMM1);
+    m_asm.xorpd(Xmm::XMM0, Xmm::XMM1);
+    return std::nullopt;
+}
+
+Value Compiler::visit(expr::Get*)
+{
+    throw Unsupported{};
+}
+
+Value Compiler::visit(expr::Set*)
+{
+    throw Unsupported{};
+}
+
+Value Compiler::visit(expr::This*)
+{
+    throw Unsupported{};
+}
+
+Value Compiler::visit(expr::Super*)
+{
+    throw Unsupported{};
+}
+
+Value Compiler::visit(expr::Invoke*)
+{
+    throw Unsupported{};
+}
+
+Value Compiler::visit(expr::ArrayLiteral*)
+{
+    throw Unsupported{};
+}
+
+Value Compiler::visit(expr::Subscript*)
+{
+    throw Unsupported{};
+}
+
+Value Compiler::visit(expr::SetSubscript*)
+{
+    throw Unsupported{};
+}
+
+Value Compiler::visit(expr::UpdateLocal* expr)
+{
+    Memory target = local(expr->m_depth, expr->m_slot);
+
+    m_asm.movsd(Xmm::XMM0, target);
+    if (expr->m_constant.has_value())
+        load_operand(expr::Operand{-1, 0, expr->m_constant.value()}, Xmm::XMM1);
+    else
+        load_right(expr->m_binary->m_right.get());
+    arithmetic(expr->m_binary->m_op);
+
+    store(target);
+    return std::nullopt;
+}
+
+Value Compiler::visit(expr::CompareLocals*)
+{
+    throw Unsupported{};
+}
+
+Value Compiler::visit(expr::UpdateField*)
+{
+    throw Unsupported{};
+}
+
+void Compiler::compile(const std::vector<StatementPtr>& stmts)
+{
+    for (const auto& stmt : stmts)
+    {
+        stmt->accept(this);
+    }
+}
+
+void Compiler::compile(expr::Expression* expr)
+{
+    expr->accept(this);
+}
+
+void Compiler::compile_loop(stmt::While* loop, bool save)
+{
+    Label head = m_asm.new_label();
+    Label end = m_asm.new_label();
+
+    m_asm.bind(head);
+    if (save)
+    {
+        m_asm.jmp(m_save);
+        m_asm.bind(m_saved);
+    }
+    branch(loop->m_condition.get(), end, false);
+    loop->m_stmt->accept(this);
+    m_asm.jmp(head);
+
+    m_asm.bind(end);
+}
+
+void Compiler::branch(expr::Expression* expr, Label target, bool jump_if)
+{
+    if (auto grouping = dynamic_cast<expr::Grouping*>(expr))
+    {
+        branch(grouping->m_expression.get(), target, jump_if);
+        return;
+    }
+
+    if (auto compare = dynamic_cast<expr::CompareLocals*>(expr))
+    {
+        load_operand(compare->m_left, Xmm::XMM0);
+        load_operand(compare->m_right, Xmm::XMM1);
+        branch_compare(compare->m_binary->m_op, target, jump_if);
+        return;
+    }
+
+    if (auto binary = dynamic_cast<expr::Binary*>(expr))
+    {
+        switch (binary->m_op.token_type())
+        {
+            case TokenType::GREATER:
+            case TokenType::GREATER_EQUAL:
+            case TokenType::LESS:
+            case TokenType::LESS_EQUAL:
+            case TokenType::EQUAL_EQUAL:
+            case TokenType::BANG_EQUAL:
+                compile(binary->m_left.get());
+                load_right(binary->m_right.get());
+                branch_compare(binary->m_op, target, jump_if);
+                return;
+            default:
+                break;
+        }
+    }
+
+    if (auto logical = dynamic_cast<expr::Logical*>(expr))
+    {
+        bool is_and = logical->m_op.token_type() == TokenType::AND;
+        // `a and b` jumps on false as soon as `a` is false, `a or b` jumps on true as soon as `a` is true.
+        // Otherwise the right operand decides.
+        if (jump_if != is_and)
+        {
+            branch(logical->m_left.get(), target, jump_if);
+            branch(logical->m_right.get(), target, jump_if);
+        }
+        else
+        {
+            Label skip = m_asm.new_label();
+            branch(logical->m_left.get(), skip, !jump_if);
+            branch(logical->m_right.get(), target, jump_if);
+            m_asm.bind(skip);
+        }
+        return;
+    }
+
+    if (auto unary = dynamic_cast<expr::Unary*>(expr); unary != nullptr && unary->m_op.token_type() == TokenType::BANG)
+    {
+        branch(unary->m_right.get(), target, !jump_if);
+        return;
+    }
+
+    if (auto literal = dynamic_cast<expr::Literal*>(expr))
+    {
+        const Value& value = *literal->m_value;
+        bool truthy = value.m_value.has_value();
+        if (truthy && std::holds_alternative<bool>(value.m_value.value()))
+            truthy = std::get<bool>(value.m_value.value());
+
+        if (truthy == jump_if)
+            m_asm.jmp(target);
+        return;
+    }
+
+    // anything else is a number, and every number is true
+    compile(expr);
+    if (jump_if)
+        m_asm.jmp(target);
+}
+
+void Compiler::branch_compare(const Token& op, Label target, bool jump_if)
+{
+    // `ucomisd` sets the flags like an unsigned comparison, and all of ZF, PF and CF when either
+    // operand is NaN. `a < b` is tested as `b > a`, so every comparison with NaN ends up false.
+    switch (op.token_type())
+    {
+        case TokenType::GREATER:
+            m_asm.ucomisd(Xmm::XMM0, Xmm::XMM1);
+            m_asm.j(jump_if ? Condition::ABOVE : Condition::BELOW_EQUAL, target);
+            return;
+        case TokenType::GREATER_EQUAL:
+            m_asm.ucomisd(Xmm::XMM0, Xmm::XMM1);
+            m_asm.j(jump_if ? Condition::ABOVE_EQUAL : Condition::BELOW, target);
+            return;
+        case TokenType::LESS:
+            m_asm.ucomisd(Xmm::XMM1, Xmm::XMM0);
+            m_asm.j(jump_if ? Condition::ABOVE : Condition::BELOW_EQUAL, target);
+            return;
+        case TokenType::LESS_EQUAL:
+            m_asm.ucomisd(Xmm::XMM1, Xmm::XMM0);
+            m_asm.j(jump_if ? Condition::ABOVE_EQUAL : Condition::BELOW, target);
+            return;
+        case TokenType::EQUAL_EQUAL:
+        case TokenType::BANG_EQUAL:
+        {
+            m_asm.ucomisd(Xmm::XMM0, Xmm::XMM1);
+            // equal means ZF set and PF clear
+            bool jump_if_equal = jump_if == (op.token_type() == TokenType::EQUAL_EQUAL);
+            if (jump_if_equal)
+            {
+                Label skip = m_asm.new_label();
+                m_asm.j(Condition::PARITY, skip);
+                m_asm.j(Condition::EQUAL, target);
+                m_asm.bind(skip);
+            }
+            else
+            {
+                m_asm.j(Condition::PARITY, target);
+                m_asm.j(Condition::NOT_EQUAL, target);
+            }
+            return;
+        }
+        default:
+            throw Unsupported{};
+    }
+}
+
+bool Compiler::load_simple(expr::Expression* expr, Xmm reg)
+{
+    if (auto variable = dynamic_cast<expr::Variable*>(expr))
+    {
+        m_asm.movsd(reg, local(variable, variable->m_name));
+        return true;
+    }
+
+    if (auto literal = dynamic_cast<expr::Literal*>(expr))
+    {
+        load_operand(expr::Operand{-1, 0, *literal->m_value}, reg);
+        return true;
+    }
+
+    return false;
+}
+
+void Compiler::load_constant(double value, Xmm reg)
+{
+    m_asm.mov(Gp::RAX, std::bit_cast<uint64_t>(value));
+    m_asm.movq(reg, Gp::RAX);
+}
+
+void Compiler::load_operand(const expr::Operand& operand, Xmm reg)
+{
+    if (operand.m_depth != -1)
+    {
+        m_asm.movsd(reg, local(operand.m_depth, operand.m_slot));
+        return;
+    }
+
+    const Value& value = operand.m_constant;
+    auto number = value.m_value.has_value() ? std::get_if<double>(&value.m_value.value()) : nullptr;
+    if (number == nullptr)
+        throw Unsupported{};
+
+    load_constant(*number, reg);
+}
+
+void Compiler::load_right(expr::Expression* right)
+{
+    if (load_simple(right, Xmm::XMM1))
+        return;
+
+    // spill the left operand while the right one is evaluated
+    m_asm.sub(Gp::RSP, 8);
+    m_asm.movsd(Memory{Gp::RSP, 0}, Xmm::XMM0);
+    compile(right);
+    m_asm.movapd(Xmm::XMM1, Xmm::XMM0);
+    m_asm.movsd(Xmm::XMM0, Memory{Gp::RSP, 0});
+    m_asm.add(Gp::RSP, 8);
+}
+
+void Compiler::arithmetic(const Token& op)
+{
+    switch (op.token_type())
+    {
+        case TokenType::PLUS:
+            m_asm.addsd(Xmm::XMM0, Xmm::XMM1);
+            break;
+        case TokenType::MINUS:
+            m_asm.subsd(Xmm::XMM0, Xmm::XMM1);
+            break;
+        case TokenType::STAR:
+            m_asm.mulsd(Xmm::XMM0, Xmm::XMM1);
+            break;
+        case TokenType::SLASH:
+            // dividing by zero is a runtime error, which the interpreter reports.
+            // A NaN divisor takes the same way out, as the comparison is unordered.
+            m_asm.xorpd(Xmm::XMM2, Xmm::XMM2);
+            m_asm.ucomisd(Xmm::XMM1, Xmm::XMM2);
+            m_asm.j(Condition::EQUAL, m_deoptimize);
+            m_asm.divsd(Xmm::XMM0, Xmm::XMM1);
+            break;
+        default:
+            throw Unsupported{};
+    }
+}
+
+Memory Compiler::local(expr::Expression* expr, const Token& name)
+{
+    std::optional<LocalSlot> slot = m_interpreter.local_slot(expr);
+    if (slot.has_value())
+        return local(slot->depth, slot->slot);
+
+    // a function can't tell whether globals change between its calls
+    if (m_loop == nullptr)
+        throw Unsupported{};
+
+    return binding(-1, 0, name.lexeme());
+}
+
+Memory Compiler::local(int depth, int slot)
+{
+    int scope = static_cast<int>(m_scopes.size()) - 1 - depth;
+    if (scope >= 0)
+        return Memory{Gp::RDI, (m_scopes[scope] + slot) * 8};
+
+    // variables outside a function are captured from its closure
+    if (m_loop == nullptr)
+        throw Unsupported{};
+
+    return binding(depth - static_cast<int>(m_scopes.size()), slot, "");
+}
+
+Memory Compiler::binding(int depth, int slot, const std::string& name)
+{
+    for (const Binding& binding : m_bindings)
+    {
+        if (binding.m_depth == depth && binding.m_slot == slot && binding.m_name == name)
+            return Memory{Gp::RDI, binding.m_local * 8};
+    }
+
+    m_bindings.push_back(Binding{depth, slot, name, m_locals++});
+    return Memory{Gp::RDI, m_bindings.back().m_local * 8};
+}
+
+void Compiler::store(Memory target)
+{
+    m_asm.movsd(target, Xmm::XMM0);
+
+    for (Binding& binding : m_bindings)
+    {
+        // marks the binding as assigned. `finish()` finds it a place to be saved in.
+        if (binding.m_local * 8 == target.disp)
+            binding.m_saved = 0;
+    }
+}
+
+void Compiler::leave(Status status)
+{
+    m_asm.mov32(Gp::RAX, static_cast<int32_t>(status));
+    m_asm.jmp(m_exit);
+}
+
+}
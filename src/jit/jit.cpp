@@ -0,0 +1,187 @@
+#include "jit/jit.h"
+
+#include "fmt/core.h"
+#include "interpreter.h"
+#include "jit/compiler.h"
+
+namespace cpplox
+{
+namespace
+{
+struct Counters
+{
+    uint64_t compiled = 0;
+    uint64_t compiled_loops = 0;
+    // hot functions and loops the compiler doesn't support
+    uint64_t rejected = 0;
+    uint64_t code_bytes = 0;
+    // calls that ran compiled code to the end
+    uint64_t compiled_calls = 0;
+    // running loops that continued in compiled code
+    uint64_t loop_entries = 0;
+    uint64_t guard_failures = 0;
+    // bailouts from the middle of compiled code
+    uint64_t bailouts = 0;
+    // functions whose code was thrown away after deoptimizing too often
+    uint64_t discarded = 0;
+};
+
+Counters g_counters;
+
+}
+
+std::optional<Value> Jit::run(const Interpreter& interpreter, ast::stmt::Function* declaration,
+                              const Environment& frame)
+{
+    jit::Tier& tier = declaration->m_tier;
+    if (tier.m_code == nullptr)
+    {
+        if (tier.m_not_compilable || ++tier.m_hotness < HOT_THRESHOLD)
+            return std::nullopt;
+
+        compile(tier, jit::Compiler{interpreter}.compile(declaration));
+        if (tier.m_code == nullptr)
+            return std::nullopt;
+        g_counters.compiled++;
+    }
+
+    const jit::Code& code = *tier.m_code;
+    if (s_locals.size() < code.locals())
+        s_locals.resize(code.locals());
+
+    // the type guard
+    int arity = declaration->m_params.size();
+    for (int i = 0; i < arity; i++)
+    {
+        const Value& arg = frame.get_at(0, i);
+        auto number = arg.m_value.has_value() ? std::get_if<double>(&arg.m_value.value()) : nullptr;
+        if (number == nullptr)
+        {
+            g_counters.guard_failures++;
+            deoptimize(tier);
+            return std::nullopt;
+        }
+
+        s_locals[i] = *number;
+    }
+
+    double result = 0;
+    switch (code.run(s_locals.data(), &result))
+    {
+        case jit::Status::RETURNED_NUMBER:
+            g_counters.compiled_calls++;
+            return Value{result};
+        case jit::Status::RETURNED_NIL:
+            g_counters.compiled_calls++;
+            return std::make_optional<Value>(std::nullopt);
+        case jit::Status::DEOPTIMIZED:
+            break;
+    }
+
+    g_counters.bailouts++;
+    deoptimize(tier);
+    return std::nullopt;
+}
+
+bool Jit::run_loop(const Interpreter& interpreter, ast::stmt::While* loop, Environment& env)
+{
+    jit::Tier& tier = loop->m_tier;
+    if (tier.m_code == nullptr)
+    {
+        if (tier.m_not_compilable || ++tier.m_hotness < HOT_THRESHOLD)
+            return false;
+
+        compile(tier, jit::Compiler{interpreter}.compile(loop));
+        if (tier.m_code == nullptr)
+            return false;
+        g_counters.compiled_loops++;
+    }
+
+    const jit::Code& code = *tier.m_code;
+    if (s_locals.size() < code.locals())
+        s_locals.resize(code.locals());
+
+    // the type guard - every variable the loop uses has to be a number
+    s_bindings.clear();
+    for (const jit::Binding& binding : code.bindings())
+    {
+        Value* variable = binding.m_depth == -1 ? interpreter.m_globals->find(binding.m_name)
+                                                : env.find_at(binding.m_depth, binding.m_slot);
+        auto number = variable != nullptr && variable->m_value.has_value()
+                          ? std::get_if<double>(&variable->m_value.value())
+                          : nullptr;
+        if (number == nullptr)
+        {
+            g_counters.guard_failures++;
+            deoptimize(tier);
+            return false;
+        }
+
+        s_locals[binding.m_local] = *number;
+        s_bindings.push_back(variable);
+    }
+
+    double result = 0;
+    bool finished = code.run(s_locals.data(), &result) != jit::Status::DEOPTIMIZED;
+
+    // a loop that bailed out goes back to the start of the iteration it was in
+    for (int i = 0; i < s_bindings.size(); i++)
+    {
+        const jit::Binding& binding = code.bindings()[i];
+        if (binding.m_saved != -1)
+            *s_bindings[i] = Value{s_locals[finished ? binding.m_local : binding.m_saved]};
+    }
+
+    if (!finished)
+    {
+        g_counters.bailouts++;
+        deoptimize(tier);
+        return false;
+    }
+
+    g_counters.loop_entries++;
+    return true;
+}
+
+void Jit::print_stats()
+{
+    fmt::print(stderr, "functions compiled:       {}\n", g_counters.compiled);
+    fmt::print(stderr, "loops compiled:           {}\n", g_counters.compiled_loops);
+    fmt::print(stderr, "code size:                {} bytes\n", g_counters.code_bytes);
+    fmt::print(stderr, "hot but not compilable:   {}\n", g_counters.rejected);
+    fmt::print(stderr, "compiled calls:           {}\n", g_counters.compiled_calls);
+    fmt::print(stderr, "loops entered while run:  {}\n", g_counters.loop_entries);
+    fmt::print(stderr, "guard failures:           {}\n", g_counters.guard_failures);
+    fmt::print(stderr, "bailouts:                 {}\n", g_counters.bailouts);
+    fmt::print(stderr, "discarded after deopts:   {}\n", g_counters.discarded);
+}
+
+void Jit::compile(jit::Tier& tier, std::shared_ptr<jit::Code> code)
+{
+#if !defined(__x86_64__)
+    // the compiler only emits x86-64
+    code.reset();
+#endif
+
+    if (code == nullptr)
+    {
+        tier.m_not_compilable = true;
+        g_counters.rejected++;
+        return;
+    }
+
+    tier.m_code = std::move(code);
+    g_counters.code_bytes += tier.m_code->size();
+}
+
+void Jit::deoptimize(jit::Tier& tier)
+{
+    if (++tier.m_code->m_deopts < MAX_DEOPTS)
+        return;
+
+    tier.m_code.reset();
+    tier.m_not_compilable = true;
+    g_counters.discarded++;
+}
+
+}
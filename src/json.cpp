@@ -0,0 +1,808 @@
+#include "json.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "array.h"
+#include "float64_array.h"
+#include "frame_pool.h"
+#include "map.h"
+#include "simd/scan.h"
+
+namespace cpplox
+{
+namespace
+{
+// Bit `i` of the result is the xor of bits 0 to `i`, so the bits of a quote mask are set
+// from each opening quote up to its closing quote
+inline std::uint64_t prefix_xor(std::uint64_t bits)
+{
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+// The bytes escaped by a backslash. A backslash that is escaped itself doesn't escape anything.
+// `carry` is whether the last byte of the previous block escapes the first byte of this one, and is updated.
+// Backslashes are rare, so this goes through them one at a time.
+inline std::uint64_t escaped_bytes(std::uint64_t backslashes, std::uint64_t& carry)
+{
+    std::uint64_t escaped = carry;
+    carry = 0;
+    backslashes &= ~escaped;
+    while (backslashes != 0)
+    {
+        int at = __builtin_ctzll(backslashes);
+        if (at == simd::BLOCK_SIZE - 1)
+        {
+            carry = 1;
+            break;
+        }
+
+        escaped |= std::uint64_t{2} << at;
+        backslashes &= ~(std::uint64_t{3} << at);
+    }
+
+    return escaped;
+}
+
+inline bool is_whitespace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+inline bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// The length of the longest start of `text` that is a number the way JSON writes them,
+// with no leading zeros, no `+`, and digits on both sides of the point. 0 if there is none.
+std::size_t json_number_length(std::string_view text)
+{
+    std::size_t i = 0;
+    if (i < text.size() && text[i] == '-')
+        i++;
+    if (i < text.size() && text[i] == '0')
+    {
+        i++;
+    }
+    else
+    {
+        if (i == text.size() || !is_digit(text[i]))
+            return 0;
+        while (i < text.size() && is_digit(text[i]))
+            i++;
+    }
+
+    std::size_t length = i;
+    if (i + 1 < text.size() && text[i] == '.' && is_digit(text[i + 1]))
+    {
+        i++;
+        while (i < text.size() && is_digit(text[i]))
+            i++;
+        length = i;
+    }
+
+    if (i < text.size() && (text[i] == 'e' || text[i] == 'E'))
+    {
+        i++;
+        if (i < text.size() && (text[i] == '+' || text[i] == '-'))
+            i++;
+        if (i < text.size() && is_digit(text[i]))
+        {
+            while (i < text.size() && is_digit(text[i]))
+                i++;
+            length = i;
+        }
+    }
+
+    return length;
+}
+
+// The value of the 4 hex digits at `digits`, or -1
+int32_t hex_value(const char* digits)
+{
+    int32_t value = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        char c = digits[i];
+        int32_t digit = is_digit(c) ? c - '0' : (c >= 'a' && c <= 'f') ? c - 'a' + 10 : (c >= 'A' && c <= 'F') ? c - 'A' + 10 : -1;
+        if (digit == -1)
+            return -1;
+        value = value * 16 + digit;
+    }
+
+    return value;
+}
+
+void append_utf8(std::string& text, uint32_t code_point)
+{
+    if (code_point < 0x80)
+    {
+        text += static_cast<char>(code_point);
+    }
+    else if (code_point < 0x800)
+    {
+        text += static_cast<char>(0xc0 | (code_point >> 6));
+        text += static_cast<char>(0x80 | (code_point & 0x3f));
+    }
+    else if (code_point < 0x10000)
+    {
+        text += static_cast<char>(0xe0 | (code_point >> 12));
+        text += static_cast<char>(0x80 | ((code_point >> 6) & 0x3f));
+        text += static_cast<char>(0x80 | (code_point & 0x3f));
+    }
+    else
+    {
+        text += static_cast<char>(0xf0 | (code_point >> 18));
+        text += static_cast<char>(0x80 | ((code_point >> 12) & 0x3f));
+        text += static_cast<char>(0x80 | ((code_point >> 6) & 0x3f));
+        text += static_cast<char>(0x80 | (code_point & 0x3f));
+    }
+}
+
+}
+
+JsonDocument::JsonDocument(std::shared_ptr<String> source)
+    : m_source(std::move(source))
+    , m_text(m_source->view())
+{
+}
+
+std::shared_ptr<JsonDocument> JsonDocument::create(std::shared_ptr<String> source)
+{
+    auto document = std::allocate_shared<JsonDocument>(FrameAllocator<JsonDocument>{}, std::move(source));
+    document->index();
+    document->match();
+    return document;
+}
+
+// For every block of 64 bytes, as bit masks:
+//  - the quotes that no backslash escapes, and from them, with a prefix xor, which bytes are inside strings
+//  - the operators `{}[]:,` and the whitespace
+//  - the first bytes of other values, the bytes that are none of those and don't follow such a byte
+// The structurals are the operators, opening quotes and first bytes that aren't inside strings.
+// Whether a block ends in an escape, a string or a value is carried over to the next block.
+void JsonDocument::index()
+{
+    if (m_text.size() > std::numeric_limits<uint32_t>::max())
+        throw NativeError{"JSON texts can't be larger than 4 GiB."};
+
+    const char* text = m_text.data();
+    std::size_t size = m_text.size();
+    std::uint64_t escape_carry = 0;
+    // all ones if the previous block ended inside a string
+    std::uint64_t string_carry = 0;
+    // 1 if the previous block ended inside a value that isn't a string
+    std::uint64_t scalar_carry = 0;
+    char padded[simd::BLOCK_SIZE];
+    for (std::size_t base = 0; base < size; base += simd::BLOCK_SIZE)
+    {
+        const char* block = text + base;
+        if (size - base < simd::BLOCK_SIZE)
+        {
+            std::memset(padded, ' ', sizeof(padded));
+            std::memcpy(padded, block, size - base);
+            block = padded;
+        }
+
+        std::uint64_t escaped = escaped_bytes(simd::block_mask(block, "\\"), escape_carry);
+        std::uint64_t quotes = simd::block_mask(block, "\"") & ~escaped;
+        std::uint64_t in_string = prefix_xor(quotes) ^ string_carry;
+        string_carry = static_cast<std::uint64_t>(static_cast<std::int64_t>(in_string) >> 63);
+
+        std::uint64_t controls = simd::block_controls(block) & in_string;
+        if (controls != 0)
+            fail(base + __builtin_ctzll(controls), "control characters in strings must be escaped");
+
+        std::uint64_t operators = simd::block_mask(block, "{}[]:,");
+        std::uint64_t whitespace = simd::block_mask(block, " \t\n\r");
+        std::uint64_t scalars = ~(operators | whitespace | quotes);
+        std::uint64_t scalar_starts = scalars & ~((scalars << 1) | scalar_carry);
+        scalar_carry = scalars >> 63;
+
+        // `in_string` has the opening quotes, and this has the rest of the strings and their closing quotes
+        std::uint64_t string_tails = in_string ^ quotes;
+        std::uint64_t structurals = (operators | quotes | scalar_starts) & ~string_tails;
+        while (structurals != 0)
+        {
+            m_positions.push_back(static_cast<uint32_t>(base + __builtin_ctzll(structurals)));
+            structurals &= structurals - 1;
+        }
+    }
+
+    if (string_carry != 0)
+        fail(size, "a string is never closed");
+}
+
+// Checks the order of the structurals with the state of a JSON grammar and a stack of open brackets.
+// The values themselves are checked when they're converted.
+void JsonDocument::match()
+{
+    enum class Expect
+    {
+        VALUE,
+        // a value or the `]` of an empty array
+        FIRST_VALUE,
+        KEY,
+        // a key or the `}` of an empty object
+        FIRST_KEY,
+        COLON,
+        // a comma or a closing bracket after a value
+        NEXT,
+    };
+
+    std::size_t count = m_positions.size();
+    if (count == 0)
+        fail(m_text.size(), "expected a value");
+
+    m_ends.resize(count);
+    std::vector<uint32_t> open;
+    Expect expect = Expect::VALUE;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        uint32_t position = m_positions[i];
+        char c = m_text[position];
+        m_ends[i] = i;
+        if ((expect == Expect::FIRST_KEY && c == '}') || (expect == Expect::FIRST_VALUE && c == ']'))
+        {
+            m_ends[open.back()] = i;
+            open.pop_back();
+            expect = Expect::NEXT;
+            continue;
+        }
+
+        switch (expect)
+        {
+            case Expect::VALUE:
+            case Expect::FIRST_VALUE:
+                if (c == '{' || c == '[')
+                {
+                    if (open.size() == MAX_DEPTH)
+                        fail(position, "objects and arrays are nested more than " + std::to_string(MAX_DEPTH) +
+                                           " levels deep");
+                    open.push_back(i);
+                    expect = c == '{' ? Expect::FIRST_KEY : Expect::FIRST_VALUE;
+                }
+                else if (c == '}' || c == ']' || c == ':' || c == ',')
+                {
+                    fail(position, "expected a value");
+                }
+                else
+                {
+                    expect = Expect::NEXT;
+                }
+                break;
+            case Expect::KEY:
+            case Expect::FIRST_KEY:
+                if (c != '"')
+                    fail(position, "expected a string key");
+                expect = Expect::COLON;
+                break;
+            case Expect::COLON:
+                if (c != ':')
+                    fail(position, "expected ':'");
+                expect = Expect::VALUE;
+                break;
+            case Expect::NEXT:
+            {
+                if (open.empty())
+                    fail(position, "expected the end of the text");
+
+                bool object = m_text[m_positions[open.back()]] == '{';
+                if (c == ',')
+                {
+                    expect = object ? Expect::KEY : Expect::VALUE;
+                }
+                else if (c == (object ? '}' : ']'))
+                {
+                    m_ends[open.back()] = i;
+                    open.pop_back();
+                }
+                else
+                {
+                    fail(position, object ? "expected ',' or '}'" : "expected ',' or ']'");
+                }
+                break;
+            }
+        }
+    }
+
+    if (expect != Expect::NEXT || !open.empty())
+        fail(m_text.size(), "the text ends too early");
+}
+
+Value JsonDocument::materialize(std::size_t at) const
+{
+    char c = m_text[m_positions[at]];
+    std::size_t close = m_ends[at];
+    if (c == '{')
+    {
+        // a member is a key, a colon, the value and a comma or the `}`
+        auto map = Map::create();
+        for (std::size_t key = at + 1; key < close; key = m_ends[key + 2] + 2)
+        {
+            map->set(this->key(key), Map::native_token(), materialize(key + 2));
+        }
+        return map;
+    }
+    if (c == '[')
+    {
+        std::vector<Value> elements;
+        for (std::size_t element = at + 1; element < close; element = m_ends[element] + 2)
+        {
+            elements.push_back(materialize(element));
+        }
+        return Array::create(std::move(elements));
+    }
+    if (c == '"')
+        return string(at);
+
+    return scalar(at);
+}
+
+Value JsonDocument::lazy(std::size_t at) const
+{
+    char c = m_text[m_positions[at]];
+    if (c == '{' || c == '[')
+        return LazyJson::create(shared_from_this(), at);
+    if (c == '"')
+        return string(at);
+
+    return scalar(at);
+}
+
+const std::vector<uint32_t>& JsonDocument::members(std::size_t at) const
+{
+    auto [entry, added] = m_members.try_emplace(at);
+    if (!added)
+        return entry->second;
+
+    bool object = is_object(at);
+    std::size_t close = m_ends[at];
+    for (std::size_t member = at + 1; member < close; member = m_ends[object ? member + 2 : member] + 2)
+    {
+        entry->second.push_back(member);
+    }
+
+    return entry->second;
+}
+
+std::shared_ptr<String> JsonDocument::string(std::size_t at) const
+{
+    const char* text = m_text.data();
+    const char* end = text + m_text.size();
+    std::size_t start = m_positions[at] + 1;
+
+    const char* cursor = text + start;
+    const char* stop = simd::find_either(cursor, end, '"', '\\');
+    if (stop != end && *stop == '"')
+        return String::slice(m_source, start, stop - cursor);
+
+    std::string decoded;
+    while (true)
+    {
+        stop = simd::find_either(cursor, end, '"', '\\');
+        decoded.append(cursor, stop);
+        if (stop == end)
+            fail(m_text.size(), "a string is never closed");
+        if (*stop == '"')
+            break;
+
+        char escape = stop + 1 < end ? stop[1] : '\0';
+        cursor = stop + 2;
+        switch (escape)
+        {
+            case '"':
+            case '\\':
+            case '/':
+                decoded += escape;
+                break;
+            case 'b':
+                decoded += '\b';
+                break;
+            case 'f':
+                decoded += '\f';
+                break;
+            case 'n':
+                decoded += '\n';
+                break;
+            case 'r':
+                decoded += '\r';
+                break;
+            case 't':
+                decoded += '\t';
+                break;
+            case 'u':
+            {
+                int32_t code_point = end - cursor >= 4 ? hex_value(cursor) : -1;
+                if (code_point == -1)
+                    fail(stop - text, "invalid \\u escape");
+                cursor += 4;
+                // characters above 0xffff are written as a pair of surrogates, and surrogates
+                // that aren't part of a pair can't be written in UTF-8, so they become U+FFFD
+                if (code_point >= 0xd800 && code_point < 0xe000)
+                {
+                    int32_t low = code_point < 0xdc00 && end - cursor >= 6 && cursor[0] == '\\' && cursor[1] == 'u'
+                                      ? hex_value(cursor + 2)
+                                      : -1;
+                    if (low >= 0xdc00 && low < 0xe000)
+                    {
+                        code_point = 0x10000 + ((code_point - 0xd800) << 10) + (low - 0xdc00);
+                        cursor += 6;
+                    }
+                    else
+                    {
+                        code_point = 0xfffd;
+                    }
+                }
+
+                append_utf8(decoded, code_point);
+                break;
+            }
+            default:
+                fail(stop - text, "invalid escape");
+        }
+    }
+
+    return String::create(std::move(decoded));
+}
+
+std::shared_ptr<String> JsonDocument::key(std::size_t at) const
+{
+    const char* text = m_text.data();
+    const char* end = text + m_text.size();
+    std::size_t start = m_positions[at] + 1;
+    const char* stop = simd::find_either(text + start, end, '"', '\\');
+    if (stop == end || *stop != '"')
+        return string(at);
+
+    auto [entry, added] = m_keys.try_emplace(std::string_view{text + start, static_cast<std::size_t>(stop - text) - start});
+    if (added)
+        entry->second = String::slice(m_source, start, entry->first.size());
+    return entry->second;
+}
+
+bool JsonDocument::key_equals(std::size_t at, std::string_view key) const
+{
+    const char* text = m_text.data();
+    const char* end = text + m_text.size();
+    const char* start = text + m_positions[at] + 1;
+    const char* stop = simd::find_either(start, end, '"', '\\');
+    if (stop != end && *stop == '"')
+        return std::string_view{start, static_cast<std::size_t>(stop - start)} == key;
+
+    return string(at)->view() == key;
+}
+
+std::string_view JsonDocument::text(std::size_t at) const
+{
+    return m_text.substr(m_positions[at], m_positions[m_ends[at]] - m_positions[at] + 1);
+}
+
+Value JsonDocument::scalar(std::size_t at) const
+{
+    // the value ends where the next structural starts, less the whitespace in between
+    std::size_t start = m_positions[at];
+    std::size_t stop = at + 1 < m_positions.size() ? m_positions[at + 1] : m_text.size();
+    while (stop > start && is_whitespace(m_text[stop - 1]))
+        stop--;
+
+    std::string_view token = m_text.substr(start, stop - start);
+    if (token == "true")
+        return static_cast<Value>(true);
+    if (token == "false")
+        return static_cast<Value>(false);
+    if (token == "null")
+        return std::nullopt;
+
+    std::size_t length = json_number_length(token);
+    if (length == 0)
+        fail(start, "expected a value");
+    // like `1 2`, a complete number followed by something else
+    if (length < token.size())
+        fail(start + length, expected_after_value(at));
+
+    double number;
+    if (!parse_number(token, number))
+        fail(start, "the number is too large");
+    return static_cast<Value>(number);
+}
+
+std::string JsonDocument::expected_after_value(std::size_t at) const
+{
+    // finds the innermost object or array around the value by skipping the ones before it
+    std::size_t depth = 0;
+    for (std::size_t i = at; i-- > 0;)
+    {
+        char c = m_text[m_positions[i]];
+        if (c == '}' || c == ']')
+        {
+            depth++;
+        }
+        else if (c == '{' || c == '[')
+        {
+            if (depth == 0)
+                return c == '{' ? "expected ',' or '}'" : "expected ',' or ']'";
+            depth--;
+        }
+    }
+
+    return "expected the end of the text";
+}
+
+void JsonDocument::fail(std::size_t position, const std::string& message) const
+{
+    throw NativeError{"Invalid JSON at byte " + std::to_string(position) + ": " + message + "."};
+}
+
+LazyJson::LazyJson(std::shared_ptr<const JsonDocument> document, std::size_t at)
+    : m_document(std::move(document))
+    , m_at(at)
+{
+}
+
+std::shared_ptr<LazyJson> LazyJson::create(std::shared_ptr<const JsonDocument> document, std::size_t at)
+{
+    return std::allocate_shared<LazyJson>(FrameAllocator<LazyJson>{}, std::move(document), at);
+}
+
+Value LazyJson::get(const Value& index, const Token& bracket) const
+{
+    try
+    {
+        if (m_document->is_object(m_at))
+        {
+            if (!index.m_value.has_value() || !std::holds_alternative<std::shared_ptr<String>>(index.m_value.value()))
+                throw RuntimeError{bracket, "JSON object keys must be strings."};
+
+            return find(std::get<std::shared_ptr<String>>(index.m_value.value())->view());
+        }
+
+        const std::vector<uint32_t>& elements = m_document->members(m_at);
+        return m_document->lazy(elements[Array::position(index, elements.size(), bracket)]);
+    }
+    catch (const NativeError& error)
+    {
+        throw RuntimeError{bracket, error.m_msg};
+    }
+}
+
+int LazyJson::method_arity(std::string_view name)
+{
+    if (name == "keys" || name == "materialize")
+        return 0;
+    if (name == "has")
+        return 1;
+
+    return -1;
+}
+
+Value LazyJson::call_method(const Token& name, const Token& paren, const std::vector<Value>& args) const
+{
+    const std::string& method = name.lexeme();
+    try
+    {
+        if (method == "materialize")
+            return m_document->materialize(m_at);
+
+        if (!m_document->is_object(m_at))
+            throw RuntimeError{name, "Only JSON objects have '" + method + "()'."};
+
+        if (method == "keys")
+        {
+            std::vector<Value> keys;
+            for (uint32_t key : m_document->members(m_at))
+            {
+                keys.emplace_back(m_document->key(key));
+            }
+            return Array::create(std::move(keys));
+        }
+
+        const Value& key = args[0];
+        if (!key.m_value.has_value() || !std::holds_alternative<std::shared_ptr<String>>(key.m_value.value()))
+            return static_cast<Value>(false);
+
+        std::string_view text = std::get<std::shared_ptr<String>>(key.m_value.value())->view();
+        for (uint32_t member : m_document->members(m_at))
+        {
+            if (m_document->key_equals(member, text))
+                return static_cast<Value>(true);
+        }
+        return static_cast<Value>(false);
+    }
+    catch (const NativeError& error)
+    {
+        throw RuntimeError{paren, error.m_msg};
+    }
+}
+
+std::string LazyJson::to_string() const
+{
+    return std::string{text()};
+}
+
+Value LazyJson::find(std::string_view key) const
+{
+    // the last member with the key wins, like in json_parse()
+    const std::vector<uint32_t>& members = m_document->members(m_at);
+    for (auto member = members.rbegin(); member != members.rend(); member++)
+    {
+        if (m_document->key_equals(*member, key))
+            return m_document->lazy(*member + 2);
+    }
+
+    return std::nullopt;
+}
+
+JsonWriter::JsonWriter(void (*sink)(std::string_view))
+    : m_sink(sink)
+{
+}
+
+void JsonWriter::write(const Value& value)
+{
+    write(value, 0);
+}
+
+void JsonWriter::finish()
+{
+    if (m_sink != nullptr && !m_text.empty())
+    {
+        m_sink(m_text);
+        m_text.clear();
+    }
+}
+
+void JsonWriter::write(const Value& value, std::size_t depth)
+{
+    if (m_sink != nullptr && m_text.size() >= CHUNK_SIZE)
+    {
+        m_sink(m_text);
+        m_text.clear();
+    }
+
+    if (!value.m_value.has_value())
+    {
+        m_text += "null";
+        return;
+    }
+
+    const auto& variant = value.m_value.value();
+    if (auto str = std::get_if<std::shared_ptr<String>>(&variant))
+        return write_string((*str)->view());
+    if (auto number = std::get_if<double>(&variant))
+        return write_number(*number);
+    if (auto boolean = std::get_if<bool>(&variant))
+    {
+        m_text += *boolean ? "true" : "false";
+        return;
+    }
+    if (auto lazy = std::get_if<std::shared_ptr<LazyJson>>(&variant))
+    {
+        m_text += (*lazy)->text();
+        return;
+    }
+
+    if (depth == JsonDocument::MAX_DEPTH)
+        throw NativeError{"Can't write values nested more than " + std::to_string(JsonDocument::MAX_DEPTH) +
+                          " levels deep as JSON, or values that contain themselves."};
+
+    if (auto array = std::get_if<std::shared_ptr<Array>>(&variant))
+    {
+        m_text += '[';
+        const std::vector<Value>& elements = (*array)->elements();
+        for (std::size_t i = 0; i < elements.size(); i++)
+        {
+            if (i != 0)
+                m_text += ',';
+            write(elements[i], depth + 1);
+        }
+        m_text += ']';
+        return;
+    }
+    if (auto map = std::get_if<std::shared_ptr<Map>>(&variant))
+    {
+        m_text += '{';
+        bool first = true;
+        (*map)->for_each(
+            [this, depth, &first](const Value& key, const Value& member)
+            {
+                if (!first)
+                    m_text += ',';
+                first = false;
+
+                NumberBuffer buffer;
+                std::string storage;
+                write_string(key.text(buffer, storage));
+                m_text += ':';
+                write(member, depth + 1);
+            });
+        m_text += '}';
+        return;
+    }
+    if (auto array = std::get_if<std::shared_ptr<Float64Array>>(&variant))
+    {
+        m_text += '[';
+        const std::vector<double>& elements = (*array)->elements();
+        for (std::size_t i = 0; i < elements.size(); i++)
+        {
+            if (i != 0)
+                m_text += ',';
+            write_number(elements[i]);
+        }
+        m_text += ']';
+        return;
+    }
+
+    throw NativeError{"Only maps, arrays, strings, numbers, booleans and nil can be written as JSON, not '" +
+                      value.to_string() + "'."};
+}
+
+void JsonWriter::write_number(double number)
+{
+    if (!std::isfinite(number))
+    {
+        m_text += "null";
+        return;
+    }
+
+    NumberBuffer buffer;
+    m_text += format_number(number, buffer);
+}
+
+void JsonWriter::write_string(std::string_view text)
+{
+    static constexpr char HEX[] = "0123456789abcdef";
+
+    m_text += '"';
+    // the characters since the last one that needed an escape
+    std::size_t run = 0;
+    for (std::size_t i = 0; i < text.size(); i++)
+    {
+        unsigned char c = text[i];
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+
+        m_text.append(text.data() + run, i - run);
+        run = i + 1;
+        switch (c)
+        {
+            case '"':
+                m_text += "\\\"";
+                break;
+            case '\\':
+                m_text += "\\\\";
+                break;
+            case '\n':
+                m_text += "\\n";
+                break;
+            case '\r':
+                m_text += "\\r";
+                break;
+            case '\t':
+                m_text += "\\t";
+                break;
+            case '\b':
+                m_text += "\\b";
+                break;
+            case '\f':
+                m_text += "\\f";
+                break;
+            default:
+                m_text += "\\u00";
+                m_text += HEX[c >> 4];
+                m_text += HEX[c & 0xf];
+        }
+    }
+    m_text.append(text.data() + run, text.size() - run);
+    m_text += '"';
+}
+
+}
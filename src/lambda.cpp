@@ -6,23 +6,21 @@ namespace cpplox
 {
 Value Lambda::call(Interpreter *interpreter, const std::vector<Value> &args)
 {
-    auto env = std::make_shared<Environment>(interpreter->m_globals);
+    auto env = Environment::create(m_closure, m_declaration->m_slots);
 
-    for (int i = 0; i < m_declaration->m_params.size(); i++)
+    for (const Value &arg : args)
     {
-        env->define(m_declaration->m_params.at(i).lexeme(), args.at(i));
+        env->define(arg);
     }
 
-    // bad. bad. bad
-    try
-    {
-        interpreter->execute_block(m_declaration->m_body, env);
-    }
-    catch (Return &return_value)
-    {
-        return return_value.m_value;
-    }
-    return std::nullopt;
+    interpreter->execute_block(m_declaration->m_body, env);
+
+    // a tail call made by the lambda runs without nesting any further
+    std::optional<TailCall> tail_call = interpreter->take_tail_call();
+    if (tail_call.has_value())
+        return tail_call->function->run(interpreter, std::move(tail_call->frame));
+
+    return interpreter->take_return_value();
 }
 
-}
\ No newline at end of file
+}
@@ -1,35 +1,86 @@
+#include <algorithm>
+#include <cstdlib>
+
+#include "fuser.h"
+#include "gc.h"
+#include "inline_cache.h"
 #include "interpreter.h"
+#include "jit/jit.h"
+#include "output.h"
 #include "parser.h"
 #include "resolver.h"
+#include "scalar_replacement.h"
 #include "scanner.h"
 #include "token.h"
 
 using namespace cpplox;
 
-int run_script(const std::string& filename, const std::vector<std::string>& modules_dirs);
+// Command line flags, passed as `--flag`
+struct Options
+{
+    // print inline cache hit/miss counters after the script finishes
+    bool ic_stats = false;
+    // print garbage collector statistics after the script finishes
+    bool gc_stats = false;
+    // compile hot functions and loops to machine code
+    bool jit = false;
+    // print how many functions the JIT compiled and how often they deoptimized
+    bool jit_stats = false;
+    // print how many instance allocations were replaced with their fields
+    bool escape_stats = false;
+    // `--output=path` - write what the script prints to a file instead of stdout
+    std::string output;
+    // `--flush=line` or `--flush=full` - when printed text is written out, see output.h
+    std::optional<Output::Flush> flush;
+};
+
+int run_script(const std::string& filename, const std::vector<std::string>& modules_dirs, const Options& options);
 // Deletes everything after the dot - 'test.cpplox' becomes 'test'
 std::string take_module_name(const std::string& str);
 int print_help();
 
 int main(int argc, char** argv)
 {
-    std::string filename = argv[1];
+    std::string filename;
     std::vector<std::string> dirs;
+    Options options;
 
-    for (int i = 2; i < argc; i++)
+    for (int i = 1; i < argc; i++)
     {
-        dirs.emplace_back(argv[i]);
+        std::string arg = argv[i];
+        if (arg == "--ic-stats")
+            options.ic_stats = true;
+        else if (arg == "--gc-stats")
+            options.gc_stats = true;
+        else if (arg == "--jit")
+            options.jit = true;
+        else if (arg == "--jit-stats")
+            options.jit_stats = true;
+        else if (arg == "--escape-stats")
+            options.escape_stats = true;
+        else if (arg.starts_with("--output="))
+            options.output = arg.substr(std::string_view{"--output="}.size());
+        else if (arg == "--flush=line")
+            options.flush = Output::Flush::LINE;
+        else if (arg == "--flush=full")
+            options.flush = Output::Flush::FULL;
+        else if (arg.starts_with("--"))
+            return print_help();
+        else if (filename.empty())
+            filename = arg;
+        else
+            dirs.emplace_back(arg);
     }
 
-    if (argc >= 2)
+    if (!filename.empty())
     {
-        return run_script(filename, dirs);
+        return run_script(filename, dirs, options);
     }
     else
         return print_help();
 }
 
-int run_script(const std::string& filename, const std::vector<std::string>& modules_dirs)
+int run_script(const std::string& filename, const std::vector<std::string>& modules_dirs, const Options& options)
 {
     Scanner scanner;
 
@@ -43,12 +94,23 @@ int run_script(const std::string& filename, const std::vector<std::string>& modu
     if (ReportError::g_had_error || !statements.has_value())
         return 65;
 
+    ScalarReplacer{}.run(statements.value());
+
     std::deque<StatementPtr> stmts_deque;
     for (const auto& stmt : statements.value())
     {
         stmts_deque.push_back(stmt);
     }
 
+    if (!options.output.empty() && !Output::open(options.output))
+    {
+        std::cerr << "Can't open output file '" << options.output << "'." << '\n';
+        return 74;
+    }
+    Output::set_flush(options.flush.value_or(Output::default_flush()));
+    // runs on every exit, including the ones errors take
+    std::atexit(Output::flush);
+
     auto interpreter = std::make_shared<Interpreter>(stmts_deque);
 
     Resolver resolver{interpreter, take_module_name(filename), modules_dirs};
@@ -57,8 +119,23 @@ int run_script(const std::string& filename, const std::vector<std::string>& modu
     if (ReportError::g_had_error)
         return 65;
 
+    Fuser fuser{*interpreter};
+    fuser.run();
+
+    if (options.jit)
+        Jit::enable();
+
     interpreter->interpret();
 
+    if (options.ic_stats)
+        InlineCache::print_stats();
+    if (options.gc_stats)
+        GarbageCollector::print_stats();
+    if (options.jit_stats)
+        Jit::print_stats();
+    if (options.escape_stats)
+        ScalarReplacer::print_stats();
+
     return 0;
 }
 
@@ -92,6 +169,6 @@ std::string take_module_name(const std::string& str)
 
 int print_help()
 {
-    std::cout << "Usage: cpplox [script]" << '\n';
+    std::cout << "Usage: cpplox [--ic-stats] [--gc-stats] [--jit] [--jit-stats] [--escape-stats] [--output=path] [--flush=line|full] [script] [module dirs...]" << '\n';
     return 64;
 }
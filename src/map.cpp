@@ -0,0 +1,240 @@
+#include "map.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "frame_pool.h"
+
+namespace cpplox
+{
+std::shared_ptr<Map> Map::create()
+{
+    return std::allocate_shared<Map>(FrameAllocator<Map>{});
+}
+
+const Token& Map::native_token()
+{
+    static const Token token{TokenType::IDENTIFIER, "<native>", std::nullopt, 0, "", 0};
+    return token;
+}
+
+Value Map::get(const Value& key, const Token& token) const
+{
+    std::ptrdiff_t slot = find(key, hash(key, token));
+    if (slot == -1)
+        return std::nullopt;
+
+    return m_entries[slot].m_value;
+}
+
+void Map::set(const Value& key, const Token& token, const Value& value)
+{
+    std::size_t key_hash = hash(key, token);
+    std::ptrdiff_t slot = find(key, key_hash);
+    if (slot != -1)
+    {
+        m_entries[slot].m_value = value;
+        return;
+    }
+
+    if ((m_size + 1) * MAX_LOAD_DENOMINATOR > m_entries.size() * MAX_LOAD_NUMERATOR)
+        grow();
+
+    insert(Entry{key, value, key_hash, 1});
+    m_size++;
+}
+
+bool Map::has(const Value& key, const Token& token) const
+{
+    return find(key, hash(key, token)) != -1;
+}
+
+bool Map::remove(const Value& key, const Token& token)
+{
+    std::ptrdiff_t found = find(key, hash(key, token));
+    if (found == -1)
+        return false;
+
+    // shift the following entries back instead of leaving a tombstone,
+    // so they stay as close to their home slots as before the removed entry was added
+    std::size_t slot = found;
+    while (true)
+    {
+        std::size_t next = home(slot + 1);
+        if (m_entries[next].m_distance <= 1)
+            break;
+
+        m_entries[slot] = std::move(m_entries[next]);
+        m_entries[slot].m_distance--;
+        slot = next;
+    }
+
+    m_entries[slot] = Entry{};
+    m_size--;
+    return true;
+}
+
+std::shared_ptr<Array> Map::keys() const
+{
+    std::vector<Value> keys;
+    keys.reserve(m_size);
+    for (const Entry& entry : m_entries)
+    {
+        if (entry.m_distance != 0)
+            keys.push_back(entry.m_key);
+    }
+
+    return Array::create(std::move(keys));
+}
+
+std::shared_ptr<Array> Map::values() const
+{
+    std::vector<Value> values;
+    values.reserve(m_size);
+    for (const Entry& entry : m_entries)
+    {
+        if (entry.m_distance != 0)
+            values.push_back(entry.m_value);
+    }
+
+    return Array::create(std::move(values));
+}
+
+int Map::method_arity(std::string_view name)
+{
+    if (name == "has" || name == "delete")
+        return 1;
+    if (name == "keys" || name == "values")
+        return 0;
+
+    return -1;
+}
+
+std::string Map::to_string() const
+{
+    if (m_printing)
+        return "{...}";
+
+    m_printing = true;
+    std::string result = "{";
+    NumberBuffer buffer;
+    std::string storage;
+    for (const Entry& entry : m_entries)
+    {
+        if (entry.m_distance == 0)
+            continue;
+
+        if (result.size() > 1)
+            result += ", ";
+        result += entry.m_key.text(buffer, storage);
+        result += ": ";
+        result += entry.m_value.text(buffer, storage);
+    }
+    m_printing = false;
+
+    return result + "}";
+}
+
+void Map::trace(Tracer& tracer) const
+{
+    for (const Entry& entry : m_entries)
+    {
+        tracer.edge(entry.m_value);
+    }
+}
+
+void Map::clear_references()
+{
+    m_entries.clear();
+    m_size = 0;
+}
+
+std::size_t Map::hash(const Value& key, const Token& token)
+{
+    if (!key.m_value.has_value())
+        throw RuntimeError{token, "Map keys must be strings, numbers or booleans."};
+
+    std::size_t result;
+    if (auto str = std::get_if<std::shared_ptr<String>>(&key.m_value.value()))
+        result = (*str)->hash();
+    else if (auto number = std::get_if<double>(&key.m_value.value()))
+    {
+        if (std::isnan(*number))
+            throw RuntimeError{token, "Map keys can't be NaN."};
+
+        // 0 and -0 are the same key
+        double normalized = *number == 0 ? 0 : *number;
+        uint64_t bits;
+        std::memcpy(&bits, &normalized, sizeof(bits));
+        result = bits;
+    }
+    else if (auto boolean = std::get_if<bool>(&key.m_value.value()))
+        result = *boolean ? 1 : 2;
+    else
+        throw RuntimeError{token, "Map keys must be strings, numbers or booleans."};
+
+    // Fibonacci hashing spreads the bits, since only the low bits pick the home slot
+    result *= 0x9E3779B97F4A7C15ULL;
+    return result ^ (result >> 32);
+}
+
+bool Map::same_key(const Value& first, const Value& second)
+{
+    if (first.m_value->index() != second.m_value->index())
+        return false;
+
+    if (auto str = std::get_if<std::shared_ptr<String>>(&first.m_value.value()))
+        return (*str)->equals(*std::get<std::shared_ptr<String>>(second.m_value.value()));
+
+    return first.m_value.value() == second.m_value.value();
+}
+
+std::ptrdiff_t Map::find(const Value& key, std::size_t hash) const
+{
+    if (m_entries.empty())
+        return -1;
+
+    std::size_t slot = home(hash);
+    // an entry further than this from its home would have taken the slot of the one we're looking for
+    for (uint32_t distance = 1; m_entries[slot].m_distance >= distance; distance++)
+    {
+        const Entry& entry = m_entries[slot];
+        if (entry.m_hash == hash && same_key(entry.m_key, key))
+            return static_cast<std::ptrdiff_t>(slot);
+
+        slot = home(slot + 1);
+    }
+
+    return -1;
+}
+
+void Map::insert(Entry entry)
+{
+    std::size_t slot = home(entry.m_hash);
+    while (m_entries[slot].m_distance != 0)
+    {
+        // take the slot of an entry that is closer to its home than this one
+        if (m_entries[slot].m_distance < entry.m_distance)
+            std::swap(m_entries[slot], entry);
+
+        slot = home(slot + 1);
+        entry.m_distance++;
+    }
+
+    m_entries[slot] = std::move(entry);
+}
+
+void Map::grow()
+{
+    std::vector<Entry> old = std::exchange(m_entries, std::vector<Entry>(std::max(MIN_CAPACITY, m_entries.size() * 2)));
+    for (Entry& entry : old)
+    {
+        if (entry.m_distance != 0)
+        {
+            entry.m_distance = 1;
+            insert(std::move(entry));
+        }
+    }
+}
+
+}
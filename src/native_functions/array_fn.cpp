@@ -0,0 +1,32 @@
+#include "native_functions/array_fn.h"
+
+#include <cmath>
+
+#include "array.h"
+
+namespace cpplox
+{
+Value ArrayFunction::call(Interpreter *, const std::vector<Value>& args)
+{
+    const Value& length = args[0];
+    if (!length.m_value.has_value() || !std::holds_alternative<double>(length.m_value.value()))
+        throw NativeError{"Array length must be a number."};
+
+    double number = std::get<double>(length.m_value.value());
+    if (number < 0 || number != std::trunc(number))
+        throw NativeError{"Array length must be a non-negative integer."};
+
+    return Array::create(std::vector<Value>(static_cast<std::size_t>(number), Value{std::nullopt}));
+}
+
+int ArrayFunction::arity() const
+{
+    return 1;
+}
+
+std::string ArrayFunction::to_string() const
+{
+    return "<fn Array>";
+}
+
+}
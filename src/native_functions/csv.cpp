@@ -0,0 +1,502 @@
+#include "native_functions/csv.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+#include "array.h"
+#include "float64_array.h"
+#include "map.h"
+#include "native_functions/files.h"
+#include "simd/scan.h"
+
+namespace cpplox
+{
+namespace
+{
+struct Options
+{
+    char m_delimiter = ',';
+    bool m_header = true;
+    // starting a thread makes every `std::shared_ptr` count atomically for the rest of the run,
+    // so a script has to ask for more threads
+    std::size_t m_threads = 1;
+};
+
+// a thread gets at least this many bytes of the file
+constexpr std::size_t MIN_CHUNK_SIZE = 1024 * 1024;
+
+// A cell of the file without its quotes. An escaped cell has `""` for every quote.
+struct Cell
+{
+    std::string_view m_text;
+    bool m_escaped = false;
+};
+
+// The rows one thread parses, [m_begin, m_end) of the file
+struct Chunk
+{
+    std::size_t m_begin = 0;
+    std::size_t m_end = 0;
+    std::size_t m_rows = 0;
+    // the numbers of every column that only has numbers so far
+    std::vector<std::vector<double>> m_numbers;
+    std::vector<char> m_numeric;
+    // the cells of every other column from the row its first cell that isn't a number is in
+    std::vector<std::vector<Cell>> m_cells;
+    std::vector<std::size_t> m_cells_from;
+    // what is wrong with row `m_rows` of the chunk, counting from 0
+    std::string m_error;
+};
+
+Options options_argument(const Value& arg)
+{
+    Options options;
+    if (!arg.m_value.has_value())
+        return options;
+
+    auto map = std::get_if<std::shared_ptr<Map>>(&arg.m_value.value());
+    if (map == nullptr)
+        throw NativeError{"'options' must be a map or nil."};
+
+    Value delimiter = (*map)->get(String::create("delimiter"), Map::native_token());
+    if (delimiter.m_value.has_value())
+    {
+        auto text = std::get_if<std::shared_ptr<String>>(&delimiter.m_value.value());
+        std::string_view view = text != nullptr ? (*text)->view() : std::string_view{};
+        if (view.size() != 1 || view[0] == '"' || view[0] == '\n' || view[0] == '\r')
+            throw NativeError{"The delimiter must be one character other than a quote or a line break."};
+        options.m_delimiter = view[0];
+    }
+
+    Value header = (*map)->get(String::create("header"), Map::native_token());
+    if (header.m_value.has_value())
+    {
+        if (!std::holds_alternative<bool>(header.m_value.value()))
+            throw NativeError{"The header option must be true or false."};
+        options.m_header = std::get<bool>(header.m_value.value());
+    }
+
+    Value threads = (*map)->get(String::create("threads"), Map::native_token());
+    if (threads.m_value.has_value())
+    {
+        auto number = std::get_if<double>(&threads.m_value.value());
+        if (number == nullptr || *number < 1 || *number != std::trunc(*number))
+            throw NativeError{"The threads option must be a positive integer."};
+        options.m_threads = static_cast<std::size_t>(*number);
+    }
+
+    return options;
+}
+
+std::string unescape(std::string_view text)
+{
+    std::string result;
+    result.reserve(text.size());
+    for (std::size_t i = 0; i < text.size(); i++)
+    {
+        result += text[i];
+        if (text[i] == '"')
+            i++;
+    }
+
+    return result;
+}
+
+// Parses the rows in [begin, end) of `text`, but no more than `max_rows`, and returns where it stopped.
+// Calls `on_cell(column, cell)` for every cell. Unless `columns` is 0, every row must have that many cells.
+// Counts the rows in `chunk.m_rows` and stops at the first malformed row, leaving what's wrong in `chunk.m_error`.
+//
+// Unquoted cells end at the next delimiter or line break, which SSE2 finds 16 bytes at a time.
+// Quoted cells end at the next quote that isn't doubled, which memchr finds.
+template <typename OnCell>
+std::size_t parse_rows(std::string_view text, std::size_t begin, std::size_t end, char delimiter,
+                       std::size_t columns, std::size_t max_rows, Chunk& chunk, OnCell on_cell)
+{
+    const char* base = text.data();
+    const char* cursor = base + begin;
+    const char* limit = base + end;
+    while (cursor < limit && chunk.m_rows < max_rows)
+    {
+        // blank lines
+        if (*cursor == '\n')
+        {
+            cursor++;
+            continue;
+        }
+        if (*cursor == '\r' && cursor + 1 < limit && cursor[1] == '\n')
+        {
+            cursor += 2;
+            continue;
+        }
+
+        const char* row = cursor;
+        std::size_t column = 0;
+        while (true)
+        {
+            Cell cell;
+            if (cursor < limit && *cursor == '"')
+            {
+                const char* start = cursor + 1;
+                const char* quote = start;
+                while (true)
+                {
+                    quote = static_cast<const char*>(std::memchr(quote, '"', limit - quote));
+                    if (quote == nullptr)
+                    {
+                        chunk.m_error = "has a quote that is never closed";
+                        return row - base;
+                    }
+                    if (quote + 1 == limit || quote[1] != '"')
+                        break;
+
+                    cell.m_escaped = true;
+                    quote += 2;
+                }
+
+                cell.m_text = {start, static_cast<std::size_t>(quote - start)};
+                cursor = quote + 1;
+                // Windows line breaks
+                if (cursor < limit && *cursor == '\r' && (cursor + 1 == limit || cursor[1] == '\n'))
+                    cursor++;
+                if (cursor < limit && *cursor != delimiter && *cursor != '\n')
+                {
+                    chunk.m_error = "has text after the closing quote of a cell";
+                    return row - base;
+                }
+            }
+            else
+            {
+                const char* stop = simd::find_either(cursor, limit, delimiter, '\n');
+                const char* last = stop;
+                // Windows line breaks
+                if (last > cursor && (stop == limit || *stop == '\n') && last[-1] == '\r')
+                    last--;
+
+                cell.m_text = {cursor, static_cast<std::size_t>(last - cursor)};
+                cursor = stop;
+            }
+
+            if (columns == 0 || column < columns)
+                on_cell(column, cell);
+            column++;
+
+            if (cursor < limit && *cursor == delimiter)
+            {
+                cursor++;
+                continue;
+            }
+            // the line break
+            if (cursor < limit)
+                cursor++;
+            break;
+        }
+
+        if (columns != 0 && column != columns)
+        {
+            chunk.m_error = "has " + std::to_string(column) + (column == 1 ? " cell" : " cells") + " instead of " +
+                            std::to_string(columns);
+            return row - base;
+        }
+        chunk.m_rows++;
+    }
+
+    return cursor - base;
+}
+
+// Splits the rows in [begin, end) into up to `count` chunks of about the same size,
+// but no more than there are hardware threads.
+// A chunk has to start at the beginning of a row, so after a line break that isn't inside quotes.
+// A position is inside quotes when an odd number of quotes come before it,
+// so every split only counts the quotes since the previous one.
+std::vector<Chunk> split_rows(std::string_view text, std::size_t begin, std::size_t end, std::size_t count)
+{
+    count = std::min<std::size_t>(count, std::max(1U, std::thread::hardware_concurrency()));
+    count = std::max<std::size_t>(1, std::min(count, (end - begin) / MIN_CHUNK_SIZE));
+
+    const char* base = text.data();
+    const char* limit = base + end;
+    std::vector<Chunk> chunks(1);
+    chunks[0].m_begin = begin;
+    // quotes before the last chunk
+    std::size_t quotes = 0;
+    for (std::size_t i = 1; i < count; i++)
+    {
+        std::size_t start = chunks.back().m_begin;
+        std::size_t target = begin + (end - begin) / count * i;
+        if (target <= start)
+            continue;
+
+        quotes += simd::count(base + start, base + target, '"');
+        bool quoted = quotes % 2 == 1;
+        const char* cursor = base + target;
+        while (cursor < limit)
+        {
+            const char* found = simd::find_either(cursor, limit, '"', '\n');
+            if (found == limit)
+            {
+                cursor = limit;
+                break;
+            }
+
+            cursor = found + 1;
+            if (*found == '"')
+            {
+                quoted = !quoted;
+                quotes++;
+            }
+            else if (!quoted)
+            {
+                break;
+            }
+        }
+        if (cursor == limit)
+            break;
+
+        chunks.back().m_end = cursor - base;
+        chunks.emplace_back().m_begin = cursor - base;
+    }
+    chunks.back().m_end = end;
+
+    return chunks;
+}
+
+// Runs `work` on every chunk, each on its own thread. The first chunk runs on this thread.
+template <typename Work>
+void for_each_chunk(std::vector<Chunk>& chunks, const Work& work)
+{
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < chunks.size(); i++)
+    {
+        threads.emplace_back([&work, &chunks, i]() { work(chunks[i]); });
+    }
+    work(chunks[0]);
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+// Reads a whole cell as a number. An empty cell is NaN.
+inline bool parse_cell(const Cell& cell, double& number)
+{
+    if (cell.m_text.empty())
+    {
+        number = std::numeric_limits<double>::quiet_NaN();
+        return true;
+    }
+    if (cell.m_escaped)
+        return false;
+
+    return parse_number(cell.m_text, number);
+}
+
+// Makes strings of cells. Equal cells get the same string, and cells without quotes to unescape
+// point into the file instead of copying it.
+class StringTable
+{
+public:
+    explicit StringTable(std::shared_ptr<const char> file)
+        : m_file(std::move(file))
+    {
+    }
+
+    std::shared_ptr<String> get(const Cell& cell)
+    {
+        if (!cell.m_escaped)
+        {
+            auto [entry, added] = m_strings.try_emplace(cell.m_text);
+            if (added)
+                entry->second = String::borrow(m_file, cell.m_text.data() - m_file.get(), cell.m_text.size());
+            return entry->second;
+        }
+
+        std::string text = unescape(cell.m_text);
+        auto found = m_strings.find(text);
+        if (found != m_strings.end())
+            return found->second;
+
+        auto str = String::create(std::move(text));
+        m_strings.emplace(str->view(), str);
+        return str;
+    }
+
+private:
+    std::shared_ptr<const char> m_file;
+    // the keys point into the strings
+    std::unordered_map<std::string_view, std::shared_ptr<String>> m_strings;
+};
+
+}
+
+// Parses the file in chunks of rows, one thread per chunk.
+// Every cell is parsed as a number until one in its column isn't, and the column's cells are kept from then on.
+// A second pass collects the cells a text column is missing, the numbers before its first text cell or
+// a whole chunk of numbers in a column that has text in another chunk. It only runs if there are any.
+// The cells become strings on this thread.
+Value ReadCsvFunction::call(Interpreter*, const std::vector<Value>& args)
+{
+    std::string path = path_argument(args[0]);
+    Options options = options_argument(args[1]);
+
+    auto table = Map::create();
+    auto [file, size] = map_whole_file(path);
+    if (file == nullptr)
+        return table;
+    std::string_view text{file.get(), size};
+
+    // the first row tells how many columns there are
+    Chunk first;
+    std::vector<std::string> names;
+    std::size_t body = parse_rows(text, 0, size, options.m_delimiter, 0, 1, first,
+                                  [&names](std::size_t, const Cell& cell)
+                                  { names.push_back(cell.m_escaped ? unescape(cell.m_text) : std::string{cell.m_text}); });
+    if (!first.m_error.empty())
+        throw NativeError{"Row 1 " + first.m_error + "."};
+    if (names.empty())
+        return table;
+    if (!options.m_header)
+        body = 0;
+
+    std::size_t columns = names.size();
+    std::vector<Chunk> chunks = split_rows(text, body, size, options.m_threads);
+    for_each_chunk(chunks,
+                   [&](Chunk& chunk)
+                   {
+                       chunk.m_numbers.resize(columns);
+                       chunk.m_numeric.assign(columns, true);
+                       chunk.m_cells.resize(columns);
+                       chunk.m_cells_from.assign(columns, 0);
+                       parse_rows(text, chunk.m_begin, chunk.m_end, options.m_delimiter, columns,
+                                  std::numeric_limits<std::size_t>::max(), chunk,
+                                  [&chunk](std::size_t column, const Cell& cell)
+                                  {
+                                      if (!chunk.m_numeric[column])
+                                      {
+                                          chunk.m_cells[column].push_back(cell);
+                                          return;
+                                      }
+
+                                      double number;
+                                      if (parse_cell(cell, number))
+                                      {
+                                          chunk.m_numbers[column].push_back(number);
+                                      }
+                                      else
+                                      {
+                                          chunk.m_numeric[column] = false;
+                                          chunk.m_numbers[column] = {};
+                                          chunk.m_cells[column].push_back(cell);
+                                          chunk.m_cells_from[column] = chunk.m_rows;
+                                      }
+                                  });
+                   });
+
+    std::size_t rows = options.m_header ? 1 : 0;
+    for (const Chunk& chunk : chunks)
+    {
+        if (!chunk.m_error.empty())
+            throw NativeError{"Row " + std::to_string(rows + chunk.m_rows + 1) + " " + chunk.m_error + "."};
+        rows += chunk.m_rows;
+    }
+    if (options.m_header)
+        rows--;
+
+    std::vector<char> numeric(columns, true);
+    for (const Chunk& chunk : chunks)
+    {
+        for (std::size_t column = 0; column < columns; column++)
+        {
+            numeric[column] = numeric[column] && chunk.m_numeric[column];
+        }
+    }
+
+    // which text columns of each chunk are missing cells
+    std::vector<std::vector<char>> missing(chunks.size(), std::vector<char>(columns, false));
+    bool any_missing = false;
+    for (std::size_t i = 0; i < chunks.size(); i++)
+    {
+        for (std::size_t column = 0; column < columns; column++)
+        {
+            missing[i][column] = !numeric[column] && (chunks[i].m_numeric[column] || chunks[i].m_cells_from[column] > 0);
+            any_missing = any_missing || missing[i][column];
+        }
+    }
+
+    if (any_missing)
+    {
+        for_each_chunk(chunks,
+                       [&](Chunk& chunk)
+                       {
+                           const std::vector<char>& collect = missing[&chunk - chunks.data()];
+                           if (std::find(collect.begin(), collect.end(), true) == collect.end())
+                               return;
+
+                           for (std::size_t column = 0; column < columns; column++)
+                           {
+                               if (collect[column])
+                                   chunk.m_cells[column].clear();
+                           }
+                           chunk.m_rows = 0;
+                           parse_rows(text, chunk.m_begin, chunk.m_end, options.m_delimiter, columns,
+                                      std::numeric_limits<std::size_t>::max(), chunk,
+                                      [&chunk, &collect](std::size_t column, const Cell& cell)
+                                      {
+                                          if (collect[column])
+                                              chunk.m_cells[column].push_back(cell);
+                                      });
+                       });
+    }
+
+    StringTable strings{file};
+    for (std::size_t column = 0; column < columns; column++)
+    {
+        Value name = options.m_header ? Value{String::create(names[column])} : Value{static_cast<double>(column)};
+        if (table->has(name, Map::native_token()))
+            throw NativeError{"Column '" + names[column] + "' appears more than once."};
+
+        if (numeric[column])
+        {
+            std::vector<double> numbers = std::move(chunks[0].m_numbers[column]);
+            numbers.reserve(rows);
+            for (std::size_t i = 1; i < chunks.size(); i++)
+            {
+                numbers.insert(numbers.end(), chunks[i].m_numbers[column].begin(), chunks[i].m_numbers[column].end());
+                chunks[i].m_numbers[column] = {};
+            }
+            table->set(name, Map::native_token(), Float64Array::create(std::move(numbers)));
+        }
+        else
+        {
+            std::vector<Value> cells;
+            cells.reserve(rows);
+            for (Chunk& chunk : chunks)
+            {
+                for (const Cell& cell : chunk.m_cells[column])
+                {
+                    cells.emplace_back(strings.get(cell));
+                }
+                chunk.m_cells[column] = {};
+            }
+            table->set(name, Map::native_token(), Array::create(std::move(cells)));
+        }
+    }
+
+    return table;
+}
+
+int ReadCsvFunction::arity() const
+{
+    return 2;
+}
+
+std::string ReadCsvFunction::to_string() const
+{
+    return "<fn read_csv>";
+}
+
+}
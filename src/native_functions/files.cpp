@@ -0,0 +1,292 @@
+#include "native_functions/files.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <tuple>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "error.h"
+
+namespace cpplox
+{
+namespace
+{
+// A read-only mapping of part of a file. Strings point into it through aliasing shared pointers.
+class Mapping
+{
+public:
+    Mapping(void* memory, std::size_t size)
+        : m_memory(memory)
+        , m_size(size)
+    {
+    }
+    ~Mapping()
+    {
+        munmap(m_memory, m_size);
+    }
+
+    Mapping(const Mapping&) = delete;
+    Mapping& operator=(const Mapping&) = delete;
+
+    [[nodiscard]] inline const char* data() const
+    {
+        return static_cast<const char*>(m_memory);
+    }
+
+private:
+    void* m_memory;
+    std::size_t m_size;
+};
+
+// Maps `length` bytes of `file` from `offset` on, which must be a multiple of the page size
+std::shared_ptr<const char> map_file(int file, std::size_t offset, std::size_t length)
+{
+    void* memory = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file, static_cast<off_t>(offset));
+    if (memory == MAP_FAILED)
+        throw NativeError{"Failed to map the file into memory."};
+
+    // the pages are read front to back, so the kernel can read ahead
+    madvise(memory, length, MADV_SEQUENTIAL);
+
+    auto mapping = std::make_shared<Mapping>(memory, length);
+    return {mapping, mapping->data()};
+}
+
+// Opens the file at `path` and returns its descriptor and size
+std::pair<int, std::size_t> open_file(const std::string& path)
+{
+    int file = open(path.c_str(), O_RDONLY);
+    if (file == -1)
+        throw NativeError{"Can't open the file '" + path + "'."};
+
+    struct stat info;
+    if (fstat(file, &info) != 0 || !S_ISREG(info.st_mode))
+    {
+        close(file);
+        throw NativeError{"'" + path + "' is not a regular file."};
+    }
+
+    return {file, static_cast<std::size_t>(info.st_size)};
+}
+
+// Reads all of `file` with read(). For files that report a size of 0 but still have contents,
+// like the ones in /proc, which can't be mapped. The text is nullptr for an empty file.
+std::pair<std::shared_ptr<const char>, std::size_t> read_unsized(int file)
+{
+    auto text = std::make_shared<std::string>();
+    char chunk[64 * 1024];
+    while (true)
+    {
+        ssize_t count = read(file, chunk, sizeof(chunk));
+        if (count == 0)
+            break;
+        if (count == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            throw NativeError{"Failed to read the file."};
+        }
+
+        text->append(chunk, static_cast<std::size_t>(count));
+    }
+
+    if (text->empty())
+        return {nullptr, 0};
+    return {std::shared_ptr<const char>(text, text->data()), text->size()};
+}
+
+}
+
+std::string path_argument(const Value& arg)
+{
+    if (!arg.m_value.has_value() || !std::holds_alternative<std::shared_ptr<String>>(arg.m_value.value()))
+        throw NativeError{"'path' must be a string."};
+
+    return std::string{std::get<std::shared_ptr<String>>(arg.m_value.value())->view()};
+}
+
+std::pair<std::shared_ptr<const char>, std::size_t> map_whole_file(const std::string& path)
+{
+    auto [file, size] = open_file(path);
+
+    // the mapping stays valid after the file is closed
+    std::shared_ptr<const char> text;
+    try
+    {
+        if (size == 0)
+            std::tie(text, size) = read_unsized(file);
+        else
+            text = map_file(file, 0, size);
+    }
+    catch (const NativeError&)
+    {
+        close(file);
+        throw;
+    }
+    close(file);
+
+    return {std::move(text), size};
+}
+
+Value ReadFileFunction::call(Interpreter*, const std::vector<Value>& args)
+{
+    auto [text, size] = map_whole_file(path_argument(args[0]));
+    if (text == nullptr)
+        return String::create("");
+
+    return String::borrow(std::move(text), 0, size);
+}
+
+int ReadFileFunction::arity() const
+{
+    return 1;
+}
+
+std::string ReadFileFunction::to_string() const
+{
+    return "<fn read_file>";
+}
+
+Value OpenLinesFunction::call(Interpreter*, const std::vector<Value>& args)
+{
+    std::string path = path_argument(args[0]);
+    auto [file, size] = open_file(path);
+    if (size != 0)
+        return std::static_pointer_cast<Callable>(std::make_shared<LineReader>(path, file, size));
+
+    std::pair<std::shared_ptr<const char>, std::size_t> text;
+    try
+    {
+        text = read_unsized(file);
+    }
+    catch (const NativeError&)
+    {
+        close(file);
+        throw;
+    }
+    close(file);
+
+    return std::static_pointer_cast<Callable>(std::make_shared<LineReader>(path, text.first, text.second));
+}
+
+int OpenLinesFunction::arity() const
+{
+    return 1;
+}
+
+std::string OpenLinesFunction::to_string() const
+{
+    return "<fn open_lines>";
+}
+
+Value NextLineFunction::call(Interpreter*, const std::vector<Value>& args)
+{
+    const Value& reader = args[0];
+    auto callable =
+        reader.m_value.has_value() ? std::get_if<std::shared_ptr<Callable>>(&reader.m_value.value()) : nullptr;
+    auto lines = callable != nullptr ? dynamic_cast<LineReader*>(callable->get()) : nullptr;
+    if (lines == nullptr)
+        throw NativeError{"'reader' must be a line reader from open_lines()."};
+
+    return lines->next();
+}
+
+int NextLineFunction::arity() const
+{
+    return 1;
+}
+
+std::string NextLineFunction::to_string() const
+{
+    return "<fn next_line>";
+}
+
+LineReader::LineReader(std::string path, int file, std::size_t size)
+    : m_path(std::move(path))
+    , m_file(file)
+    , m_size(size)
+{
+}
+
+LineReader::LineReader(std::string path, std::shared_ptr<const char> text, std::size_t size)
+    : m_path(std::move(path))
+    , m_file(-1)
+    , m_size(size)
+    , m_window(std::move(text))
+    , m_window_end(size)
+{
+}
+
+LineReader::~LineReader()
+{
+    if (m_file != -1)
+        close(m_file);
+}
+
+Value LineReader::next()
+{
+    if (m_position >= m_size)
+        return std::nullopt;
+
+    if (m_window == nullptr || m_position >= m_window_end)
+        map(m_position, WINDOW_SIZE);
+
+    const char* newline;
+    while (true)
+    {
+        const char* window = m_window.get();
+        newline = static_cast<const char*>(
+            std::memchr(window + (m_position - m_window_start), '\n', m_window_end - m_position));
+        if (newline != nullptr || m_window_end == m_size)
+            break;
+
+        // the line goes on past the window - map a window twice as big that starts with the line
+        map(m_position, 2 * (m_window_end - m_window_start));
+    }
+
+    std::size_t start = m_position - m_window_start;
+    std::size_t end = newline != nullptr ? newline - m_window.get() : m_window_end - m_window_start;
+    m_position = m_window_start + end + 1;
+
+    // Windows line breaks
+    if (end > start && m_window.get()[end - 1] == '\r')
+        end--;
+
+    return String::borrow(m_window, start, end - start);
+}
+
+Value LineReader::call(Interpreter*, const std::vector<Value>&)
+{
+    return next();
+}
+
+int LineReader::arity() const
+{
+    return 0;
+}
+
+std::string LineReader::to_string() const
+{
+    return "<lines of " + m_path + ">";
+}
+
+void LineReader::map(std::size_t position, std::size_t length)
+{
+    static const std::size_t page_size = sysconf(_SC_PAGESIZE);
+
+    std::size_t start = position - position % page_size;
+    std::size_t end = std::min(start + length, m_size);
+
+    // drop our reference first, so an old window that no line uses is unmapped before the new one is mapped
+    m_window.reset();
+    m_window = map_file(m_file, start, end - start);
+    m_window_start = start;
+    m_window_end = end;
+}
+
+}
@@ -0,0 +1,48 @@
+#include "native_functions/float64_array_fn.h"
+
+#include <cmath>
+
+#include "array.h"
+#include "float64_array.h"
+
+namespace cpplox
+{
+Value Float64ArrayFunction::call(Interpreter *, const std::vector<Value>& args)
+{
+    const Value& source = args[0];
+    if (source.m_value.has_value() && std::holds_alternative<double>(source.m_value.value()))
+    {
+        double number = std::get<double>(source.m_value.value());
+        if (number < 0 || number != std::trunc(number))
+            throw NativeError{"Float64Array length must be a non-negative integer."};
+
+        return Float64Array::create(std::vector<double>(static_cast<std::size_t>(number)));
+    }
+
+    auto array = source.m_value.has_value() ? std::get_if<std::shared_ptr<Array>>(&source.m_value.value()) : nullptr;
+    if (array == nullptr)
+        throw NativeError{"Float64Array expects a length or an array of numbers."};
+
+    std::vector<double> elements;
+    elements.reserve((*array)->length());
+    for (const Value& element : (*array)->elements())
+    {
+        if (!element.m_value.has_value() || !std::holds_alternative<double>(element.m_value.value()))
+            throw NativeError{"Float64Array elements must be numbers."};
+        elements.push_back(std::get<double>(element.m_value.value()));
+    }
+
+    return Float64Array::create(std::move(elements));
+}
+
+int Float64ArrayFunction::arity() const
+{
+    return 1;
+}
+
+std::string Float64ArrayFunction::to_string() const
+{
+    return "<fn Float64Array>";
+}
+
+}
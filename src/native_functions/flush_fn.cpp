@@ -0,0 +1,23 @@
+#include "native_functions/flush_fn.h"
+
+#include "output.h"
+
+namespace cpplox
+{
+Value FlushFunction::call(Interpreter *, const std::vector<Value>&)
+{
+    Output::flush();
+    return std::nullopt;
+}
+
+int FlushFunction::arity() const
+{
+    return 0;
+}
+
+std::string FlushFunction::to_string() const
+{
+    return "<fn flush>";
+}
+
+}
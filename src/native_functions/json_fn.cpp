@@ -0,0 +1,84 @@
+#include "native_functions/json_fn.h"
+
+#include "json.h"
+#include "output.h"
+
+namespace cpplox
+{
+namespace
+{
+std::shared_ptr<JsonDocument> parse(const Value& text)
+{
+    if (!text.m_value.has_value() || !std::holds_alternative<std::shared_ptr<String>>(text.m_value.value()))
+        throw NativeError{"'text' must be a string."};
+
+    return JsonDocument::create(std::get<std::shared_ptr<String>>(text.m_value.value()));
+}
+}
+
+Value JsonParseFunction::call(Interpreter*, const std::vector<Value>& args)
+{
+    return parse(args[0])->materialize(0);
+}
+
+int JsonParseFunction::arity() const
+{
+    return 1;
+}
+
+std::string JsonParseFunction::to_string() const
+{
+    return "<fn json_parse>";
+}
+
+Value JsonParseLazyFunction::call(Interpreter*, const std::vector<Value>& args)
+{
+    return parse(args[0])->lazy(0);
+}
+
+int JsonParseLazyFunction::arity() const
+{
+    return 1;
+}
+
+std::string JsonParseLazyFunction::to_string() const
+{
+    return "<fn json_parse_lazy>";
+}
+
+Value JsonStringifyFunction::call(Interpreter*, const std::vector<Value>& args)
+{
+    JsonWriter writer;
+    writer.write(args[0]);
+    return String::create(std::move(writer.text()));
+}
+
+int JsonStringifyFunction::arity() const
+{
+    return 1;
+}
+
+std::string JsonStringifyFunction::to_string() const
+{
+    return "<fn json_stringify>";
+}
+
+Value JsonWriteFunction::call(Interpreter*, const std::vector<Value>& args)
+{
+    JsonWriter writer{Output::write};
+    writer.write(args[0]);
+    writer.finish();
+    return std::nullopt;
+}
+
+int JsonWriteFunction::arity() const
+{
+    return 1;
+}
+
+std::string JsonWriteFunction::to_string() const
+{
+    return "<fn json_write>";
+}
+
+}
@@ -0,0 +1,22 @@
+#include "native_functions/map_fn.h"
+
+#include "map.h"
+
+namespace cpplox
+{
+Value MapFunction::call(Interpreter *, const std::vector<Value>&)
+{
+    return Map::create();
+}
+
+int MapFunction::arity() const
+{
+    return 0;
+}
+
+std::string MapFunction::to_string() const
+{
+    return "<fn Map>";
+}
+
+}
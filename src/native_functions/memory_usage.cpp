@@ -0,0 +1,30 @@
+#include "native_functions/memory_usage.h"
+
+#include <fstream>
+
+#include <unistd.h>
+
+namespace cpplox
+{
+Value MemoryUsageFunction::call(Interpreter *, const std::vector<Value>&)
+{
+    // the second field of /proc/self/statm is the resident set size in pages
+    std::ifstream statm{"/proc/self/statm"};
+    long size = 0;
+    long resident = 0;
+    statm >> size >> resident;
+
+    return static_cast<Value>(static_cast<double>(resident * sysconf(_SC_PAGESIZE)));
+}
+
+int MemoryUsageFunction::arity() const
+{
+    return 0;
+}
+
+std::string MemoryUsageFunction::to_string() const
+{
+    return "<fn memory_usage>";
+}
+
+}
@@ -1,11 +1,13 @@
 #include "native_functions/println.h"
 
+#include "output.h"
+
 namespace cpplox
 {
 
 Value PrintlnFunction::call(Interpreter *interpreter, const std::vector<Value>& args)
 {
-    fmt::print("{}\n", args[0].to_string());
+    Output::write_line(args[0]);
     return std::nullopt;
 }
 
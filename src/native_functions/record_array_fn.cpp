@@ -0,0 +1,40 @@
+#include "native_functions/record_array_fn.h"
+
+#include <cmath>
+
+#include "class.h"
+#include "record_array.h"
+
+namespace cpplox
+{
+Value RecordArrayFunction::call(Interpreter *, const std::vector<Value>& args)
+{
+    const Value& type = args[0];
+    auto callable =
+        type.m_value.has_value() ? std::get_if<std::shared_ptr<Callable>>(&type.m_value.value()) : nullptr;
+    auto record = callable != nullptr ? std::dynamic_pointer_cast<Class>(*callable) : nullptr;
+    if (record == nullptr || !record->is_record())
+        throw NativeError{"RecordArray expects a record type."};
+
+    const Value& length = args[1];
+    if (!length.m_value.has_value() || !std::holds_alternative<double>(length.m_value.value()))
+        throw NativeError{"RecordArray length must be a number."};
+
+    double number = std::get<double>(length.m_value.value());
+    if (number < 0 || number != std::trunc(number))
+        throw NativeError{"RecordArray length must be a non-negative integer."};
+
+    return RecordArray::create(record, static_cast<std::size_t>(number));
+}
+
+int RecordArrayFunction::arity() const
+{
+    return 2;
+}
+
+std::string RecordArrayFunction::to_string() const
+{
+    return "<fn RecordArray>";
+}
+
+}
@@ -0,0 +1,22 @@
+#include "native_functions/string_builder_fn.h"
+
+#include "string_builder.h"
+
+namespace cpplox
+{
+Value StringBuilderFunction::call(Interpreter *, const std::vector<Value>&)
+{
+    return StringBuilder::create();
+}
+
+int StringBuilderFunction::arity() const
+{
+    return 0;
+}
+
+std::string StringBuilderFunction::to_string() const
+{
+    return "<fn StringBuilder>";
+}
+
+}
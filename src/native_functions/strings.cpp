@@ -0,0 +1,243 @@
+#include "native_functions/strings.h"
+
+#include <cmath>
+#include <string_view>
+
+#include "array.h"
+#include "simd/search.h"
+
+namespace cpplox
+{
+namespace
+{
+const std::shared_ptr<String>& string_argument(const Value& arg, const char* name)
+{
+    if (!arg.m_value.has_value() || !std::holds_alternative<std::shared_ptr<String>>(arg.m_value.value()))
+        throw NativeError{std::string{"'"} + name + "' must be a string."};
+
+    return std::get<std::shared_ptr<String>>(arg.m_value.value());
+}
+
+std::size_t integer_argument(const Value& arg, const char* name)
+{
+    if (!arg.m_value.has_value() || !std::holds_alternative<double>(arg.m_value.value()))
+        throw NativeError{std::string{"'"} + name + "' must be a number."};
+
+    double number = std::get<double>(arg.m_value.value());
+    if (number < 0 || number != std::trunc(number))
+        throw NativeError{std::string{"'"} + name + "' must be a non-negative integer."};
+
+    return static_cast<std::size_t>(number);
+}
+
+}
+
+Value FindFunction::call(Interpreter*, const std::vector<Value>& args)
+{
+    std::string_view text = string_argument(args[0], "text")->view();
+    std::string_view pattern = string_argument(args[1], "pattern")->view();
+
+    std::size_t position = simd::find(text, pattern);
+    return static_cast<Value>(position == std::string_view::npos ? -1.0 : static_cast<double>(position));
+}
+
+int FindFunction::arity() const
+{
+    return 2;
+}
+
+std::string FindFunction::to_string() const
+{
+    return "<fn find>";
+}
+
+Value ContainsFunction::call(Interpreter*, const std::vector<Value>& args)
+{
+    std::string_view text = string_argument(args[0], "text")->view();
+    std::string_view pattern = string_argument(args[1], "pattern")->view();
+
+    return static_cast<Value>(simd::find(text, pattern) != std::string_view::npos);
+}
+
+int ContainsFunction::arity() const
+{
+    return 2;
+}
+
+std::string ContainsFunction::to_string() const
+{
+    return "<fn contains>";
+}
+
+Value StartsWithFunction::call(Interpreter*, const std::vector<Value>& args)
+{
+    std::string_view text = string_argument(args[0], "text")->view();
+    std::string_view prefix = string_argument(args[1], "prefix")->view();
+
+    return static_cast<Value>(text.starts_with(prefix));
+}
+
+int StartsWithFunction::arity() const
+{
+    return 2;
+}
+
+std::string StartsWithFunction::to_string() const
+{
+    return "<fn starts_with>";
+}
+
+Value SplitFunction::call(Interpreter*, const std::vector<Value>& args)
+{
+    const std::shared_ptr<String>& text = string_argument(args[0], "text");
+    std::string_view separator = string_argument(args[1], "separator")->view();
+    if (separator.empty())
+        throw NativeError{"'separator' can't be empty."};
+
+    std::string_view view = text->view();
+    std::vector<Value> parts;
+    std::size_t start = 0;
+    for (std::size_t end = simd::find(view, separator); end != std::string_view::npos;
+         end = simd::find(view, separator, start))
+    {
+        parts.emplace_back(String::slice(text, start, end - start));
+        start = end + separator.size();
+    }
+    parts.emplace_back(String::slice(text, start, view.size() - start));
+
+    return Array::create(std::move(parts));
+}
+
+int SplitFunction::arity() const
+{
+    return 2;
+}
+
+std::string SplitFunction::to_string() const
+{
+    return "<fn split>";
+}
+
+Value JoinFunction::call(Interpreter*, const std::vector<Value>& args)
+{
+    const Value& array_arg = args[0];
+    auto array =
+        array_arg.m_value.has_value() ? std::get_if<std::shared_ptr<Array>>(&array_arg.m_value.value()) : nullptr;
+    if (array == nullptr)
+        throw NativeError{"'array' must be an array."};
+    std::string_view separator = string_argument(args[1], "separator")->view();
+
+    const std::vector<Value>& elements = (*array)->elements();
+    if (elements.empty())
+        return String::create("");
+
+    NumberBuffer buffer;
+    std::string storage;
+    // measure first, so the result is allocated once
+    std::size_t size = separator.size() * (elements.size() - 1);
+    for (const Value& element : elements)
+    {
+        size += element.text(buffer, storage).size();
+    }
+
+    std::string result;
+    result.reserve(size);
+    for (std::size_t i = 0; i < elements.size(); i++)
+    {
+        if (i != 0)
+            result += separator;
+        result += elements[i].text(buffer, storage);
+    }
+
+    return String::create(std::move(result));
+}
+
+int JoinFunction::arity() const
+{
+    return 2;
+}
+
+std::string JoinFunction::to_string() const
+{
+    return "<fn join>";
+}
+
+Value ReplaceFunction::call(Interpreter*, const std::vector<Value>& args)
+{
+    const std::shared_ptr<String>& text = string_argument(args[0], "text");
+    std::string_view pattern = string_argument(args[1], "pattern")->view();
+    std::string_view replacement = string_argument(args[2], "replacement")->view();
+    if (pattern.empty())
+        throw NativeError{"'pattern' can't be empty."};
+
+    std::string_view view = text->view();
+    std::size_t found = simd::find(view, pattern);
+    if (found == std::string_view::npos)
+        return text;
+
+    std::string result;
+    result.reserve(view.size());
+    std::size_t start = 0;
+    for (; found != std::string_view::npos; found = simd::find(view, pattern, start))
+    {
+        result += view.substr(start, found - start);
+        result += replacement;
+        start = found + pattern.size();
+    }
+    result += view.substr(start);
+
+    return String::create(std::move(result));
+}
+
+int ReplaceFunction::arity() const
+{
+    return 3;
+}
+
+std::string ReplaceFunction::to_string() const
+{
+    return "<fn replace>";
+}
+
+Value SubstrFunction::call(Interpreter*, const std::vector<Value>& args)
+{
+    const std::shared_ptr<String>& text = string_argument(args[0], "text");
+    std::size_t start = integer_argument(args[1], "start");
+    std::size_t length = integer_argument(args[2], "length");
+    if (start > text->length() || length > text->length() - start)
+        throw NativeError{"Substring out of bounds."};
+
+    return String::slice(text, start, length);
+}
+
+int SubstrFunction::arity() const
+{
+    return 3;
+}
+
+std::string SubstrFunction::to_string() const
+{
+    return "<fn substr>";
+}
+
+Value CharCodeFunction::call(Interpreter*, const std::vector<Value>& args)
+{
+    std::string_view text = string_argument(args[0], "text")->view();
+    std::size_t index = integer_argument(args[1], "index");
+    if (index >= text.size())
+        throw NativeError{"Index out of bounds."};
+
+    return static_cast<Value>(static_cast<double>(static_cast<unsigned char>(text[index])));
+}
+
+int CharCodeFunction::arity() const
+{
+    return 2;
+}
+
+std::string CharCodeFunction::to_string() const
+{
+    return "<fn char_code>";
+}
+
+}
@@ -0,0 +1,69 @@
+#include "output.h"
+
+#include <cstring>
+
+#include <unistd.h>
+
+namespace cpplox
+{
+bool Output::open(const std::string& path)
+{
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (file == nullptr)
+        return false;
+
+    flush();
+    s_file = file;
+    return true;
+}
+
+Output::Flush Output::default_flush()
+{
+    return isatty(fileno(s_file)) ? Flush::LINE : Flush::FULL;
+}
+
+void Output::write(std::string_view text)
+{
+    if (text.size() > BUFFER_SIZE - s_used)
+    {
+        flush();
+        // too big to buffer - write it straight out
+        if (text.size() >= BUFFER_SIZE)
+        {
+            std::fwrite(text.data(), 1, text.size(), s_file);
+            std::fflush(s_file);
+            return;
+        }
+    }
+
+    std::memcpy(s_buffer.data() + s_used, text.data(), text.size());
+    s_used += text.size();
+
+    if (s_flush == Flush::LINE && std::memchr(text.data(), '\n', text.size()) != nullptr)
+        flush();
+}
+
+void Output::write(const Value& value)
+{
+    NumberBuffer buffer;
+    std::string storage;
+    write(value.text(buffer, storage));
+}
+
+void Output::write_line(const Value& value)
+{
+    write(value);
+    write("\n");
+}
+
+void Output::flush()
+{
+    if (s_used != 0)
+    {
+        std::fwrite(s_buffer.data(), 1, s_used, s_file);
+        s_used = 0;
+    }
+    std::fflush(s_file);
+}
+
+}
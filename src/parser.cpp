@@ -1,5 +1,7 @@
 #include "parser.h"
 
+#include <algorithm>
+
 namespace cpplox
 {
 std::optional<std::vector<StatementPtr>> Parser::parse()
@@ -70,6 +72,12 @@ ExpressionPtr Parser::assignment()
             auto get = std::dynamic_pointer_cast<expr::Get>(expr);
             return std::make_shared<expr::Set>(get->m_object, get->m_name, value);
         }
+        else if (typeid(*expr) == typeid(expr::Subscript))
+        {
+            auto subscript = std::dynamic_pointer_cast<expr::Subscript>(expr);
+            return std::make_shared<expr::SetSubscript>(subscript->m_object, subscript->m_bracket, subscript->m_index,
+                                                        value);
+        }
 
         // no need to throw an exception here,
         // because the parser is not in a confused state
@@ -191,6 +199,13 @@ ExpressionPtr Parser::call()
             Token name = consume(TokenType::IDENTIFIER, "Expect property name after '.'.");
             expr = std::make_shared<expr::Get>(expr, name);
         }
+        else if (match({TokenType::LEFT_BRACKET}))
+        {
+            Token bracket = previous();
+            ExpressionPtr index = expression();
+            consume(TokenType::RIGHT_BRACKET, "Expect ']' after index.");
+            expr = std::make_shared<expr::Subscript>(expr, bracket, index);
+        }
         else
             break;
     }
@@ -228,6 +243,22 @@ ExpressionPtr Parser::primary()
         return std::make_shared<expr::Variable>(previous());
     }
 
+    if (match({TokenType::LEFT_BRACKET}))
+    {
+        Token bracket = previous();
+        std::vector<ExpressionPtr> elements;
+        if (!check(TokenType::RIGHT_BRACKET))
+        {
+            do
+            {
+                elements.emplace_back(expression());
+            } while (match({TokenType::COMMA}));
+        }
+
+        consume(TokenType::RIGHT_BRACKET, "Expect ']' after array elements.");
+        return std::make_shared<expr::ArrayLiteral>(bracket, elements);
+    }
+
     if (match({TokenType::LEFT_PAREN}))
     {
         ExpressionPtr mid_expr = expression();
@@ -256,6 +287,8 @@ StatementPtr Parser::declaration()
             return import();
         if (match({TokenType::CLASS}))
             return class_declaration();
+        if (match({TokenType::RECORD}))
+            return record_declaration();
         if (match({TokenType::FUN}))
             return function("function");
         if (match({TokenType::VAR}))
@@ -294,6 +327,31 @@ StatementPtr Parser::class_declaration()
     return std::make_shared<stmt::Class>(name, superclass, methods);
 }
 
+StatementPtr Parser::record_declaration()
+{
+    Token name = consume(TokenType::IDENTIFIER, "Expect record name.");
+    consume(TokenType::LEFT_BRACE, "Expect '{' before record fields.");
+
+    std::vector<Token> fields;
+    if (!check(TokenType::RIGHT_BRACE))
+    {
+        do
+        {
+            if (fields.size() >= 255)
+                error(peek(), "Can't have more than 255 fields.");
+
+            Token field = consume(TokenType::IDENTIFIER, "Expect field name.");
+            if (std::any_of(fields.begin(), fields.end(), [&](const Token& other) { return other == field.lexeme(); }))
+                error(field, "Already a field with this name in this record.");
+            fields.push_back(field);
+        } while (match({TokenType::COMMA}));
+    }
+
+    consume(TokenType::RIGHT_BRACE, "Expect '}' after record fields.");
+
+    return std::make_shared<stmt::Class>(name, std::nullopt, std::vector<std::shared_ptr<stmt::Function>>{}, fields);
+}
+
 StatementPtr Parser::function(const std::string& kind)
 {
     std::vector<Token> prefixes;
@@ -505,6 +563,13 @@ ExpressionPtr Parser::finish_call(const ExpressionPtr& callee)
 
     Token paren = consume(TokenType::RIGHT_PAREN, "Expect ')' after arguments.");
 
+    // `object.method(args)` is called directly without creating a bound method
+    if (typeid(*callee) == typeid(expr::Get))
+    {
+        auto get = std::dynamic_pointer_cast<expr::Get>(callee);
+        return std::make_shared<expr::Invoke>(get->m_object, get->m_name, paren, args);
+    }
+
     return std::make_shared<expr::Call>(callee, paren, args);
 }
 
@@ -577,6 +642,7 @@ void Parser::synchronize()
         switch (peek().token_type())
         {
             case TokenType::CLASS:
+            case TokenType::RECORD:
             case TokenType::FUN:
             case TokenType::VAR:
             case TokenType::FOR:
@@ -585,6 +651,8 @@ void Parser::synchronize()
             case TokenType::PRINT:
             case TokenType::RETURN:
                 return;
+            default:
+                break;
         }
 
         advance();
@@ -0,0 +1,113 @@
+#include "record_array.h"
+
+#include "frame_pool.h"
+#include "instance.h"
+
+namespace cpplox
+{
+RecordArray::RecordArray(const std::shared_ptr<Class>& record, std::size_t length)
+    : m_record(record)
+    , m_length(length)
+{
+    int fields = record->root_shape()->size();
+    m_columns.reserve(fields);
+    for (int slot = 0; slot < fields; slot++)
+    {
+        auto column = Array::create(std::vector<Value>(length, Value{std::nullopt}));
+        column->fix_length();
+        m_columns.push_back(std::move(column));
+    }
+}
+
+std::shared_ptr<RecordArray> RecordArray::create(const std::shared_ptr<Class>& record, std::size_t length)
+{
+    return std::allocate_shared<RecordArray>(FrameAllocator<RecordArray>{}, record, length);
+}
+
+Value RecordArray::get(const Value& index, const Token& bracket) const
+{
+    std::size_t row = Array::position(index, m_length, bracket);
+
+    auto instance = std::allocate_shared<Instance>(FrameAllocator<Instance>{}, m_record);
+    for (std::size_t slot = 0; slot < m_columns.size(); slot++)
+    {
+        instance->set_field(slot, m_columns[slot]->elements()[row]);
+    }
+
+    return instance;
+}
+
+void RecordArray::set(const Value& index, const Token& bracket, const Value& value)
+{
+    std::size_t row = Array::position(index, m_length, bracket);
+    const Instance& instance = record(value, bracket);
+
+    Value position{static_cast<double>(row)};
+    for (std::size_t slot = 0; slot < m_columns.size(); slot++)
+    {
+        m_columns[slot]->set(position, bracket, instance.field(slot));
+    }
+}
+
+void RecordArray::push(const Value& value, const Token& token)
+{
+    const Instance& instance = record(value, token);
+    for (std::size_t slot = 0; slot < m_columns.size(); slot++)
+    {
+        m_columns[slot]->push(instance.field(slot));
+    }
+    m_length++;
+}
+
+std::shared_ptr<Array> RecordArray::column(const Value& name, const Token& token) const
+{
+    if (!name.m_value.has_value() || !std::holds_alternative<std::shared_ptr<String>>(name.m_value.value()))
+        throw RuntimeError{token, "Column name must be a string."};
+
+    std::string field{std::get<std::shared_ptr<String>>(name.m_value.value())->view()};
+    int slot = m_record->root_shape()->lookup(field);
+    if (slot == -1)
+        throw RuntimeError{token, "Record '" + m_record->m_name + "' has no field '" + field + "'."};
+
+    return m_columns[slot];
+}
+
+int RecordArray::method_arity(std::string_view name)
+{
+    if (name == "push" || name == "column")
+        return 1;
+
+    return -1;
+}
+
+std::string RecordArray::to_string() const
+{
+    return "<RecordArray " + m_record->m_name + ">";
+}
+
+void RecordArray::trace(Tracer& tracer) const
+{
+    tracer.edge(m_record);
+    for (const auto& column : m_columns)
+    {
+        tracer.edge(column);
+    }
+}
+
+void RecordArray::clear_references()
+{
+    m_record.reset();
+    m_columns.clear();
+}
+
+const Instance& RecordArray::record(const Value& value, const Token& token) const
+{
+    auto instance =
+        value.m_value.has_value() ? std::get_if<std::shared_ptr<Instance>>(&value.m_value.value()) : nullptr;
+    if (instance == nullptr || (*instance)->klass() != m_record)
+        throw RuntimeError{token, "Expected a '" + m_record->m_name + "' record."};
+
+    return **instance;
+}
+
+}
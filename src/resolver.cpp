@@ -6,6 +6,7 @@ void Resolver::visit(stmt::Block *stmt)
 {
     begin_scope();
     resolve(stmt->m_statements);
+    stmt->m_slots = m_scopes.back().size();
     end_scope();
 }
 
@@ -58,6 +59,11 @@ void Resolver::visit(stmt::Return *stmt)
             error(stmt->m_keyword, "Can't return a value from an initializer.");
 
         resolve(stmt->m_value->get());
+
+        // nothing is left to do in the function after the call,
+        // so the interpreter can reuse the function's place for the callee
+        auto &value = *stmt->m_value.value();
+        stmt->m_is_tail_call = typeid(value) == typeid(expr::Call) || typeid(value) == typeid(expr::Invoke);
     }
 }
 
@@ -89,11 +95,11 @@ void Resolver::visit(stmt::Class *stmt)
         resolve(stmt->m_super->get());
 
         begin_scope();
-        m_scopes.back().emplace("super", true);
+        m_scopes.back().emplace("super", LocalVariable{true, 0});
     }
 
     begin_scope();
-    m_scopes.back().emplace("this", true);
+    m_scopes.back().emplace("this", LocalVariable{true, 0});
 
     for (const auto &method : stmt->m_methods)
     {
@@ -120,8 +126,8 @@ Value Resolver::visit(expr::Variable *expr)
 {
     if (!m_scopes.empty())
     {
-        auto is_ready = m_scopes.back().find(expr->m_name.lexeme());
-        if (is_ready != m_scopes.back().end() && !is_ready->second)
+        auto variable = m_scopes.back().find(expr->m_name.lexeme());
+        if (variable != m_scopes.back().end() && !variable->second.is_ready)
         {
             error(expr->m_name, "Can't read local variable in its own initializer.");
         }
@@ -154,6 +160,7 @@ Value Resolver::visit(expr::Lambda *expr)
     }
 
     resolve(expr->m_body);
+    expr->m_slots = m_scopes.back().size();
 
     end_scope();
 
@@ -251,6 +258,60 @@ Value Resolver::visit(expr::Super *expr)
     return std::nullopt;
 }
 
+Value Resolver::visit(expr::Invoke *expr)
+{
+    resolve(expr->m_object.get());
+
+    for (const auto &arg : expr->m_args)
+    {
+        resolve(arg.get());
+    }
+
+    return std::nullopt;
+}
+
+Value Resolver::visit(expr::ArrayLiteral *expr)
+{
+    for (const auto &element : expr->m_elements)
+    {
+        resolve(element.get());
+    }
+
+    return std::nullopt;
+}
+
+Value Resolver::visit(expr::Subscript *expr)
+{
+    resolve(expr->m_object.get());
+    resolve(expr->m_index.get());
+
+    return std::nullopt;
+}
+
+Value Resolver::visit(expr::SetSubscript *expr)
+{
+    resolve(expr->m_object.get());
+    resolve(expr->m_index.get());
+    resolve(expr->m_value.get());
+
+    return std::nullopt;
+}
+
+Value Resolver::visit(expr::UpdateLocal *)
+{
+    return std::nullopt;
+}
+
+Value Resolver::visit(expr::CompareLocals *)
+{
+    return std::nullopt;
+}
+
+Value Resolver::visit(expr::UpdateField *)
+{
+    return std::nullopt;
+}
+
 void Resolver::resolve(const std::vector<StatementPtr> &stmts)
 {
     for (const auto &stmt : stmts)
@@ -284,14 +345,16 @@ void Resolver::resolve_local(expr::Expression *expr, const Token &name)
     // we start iterating from the end,
     // because we need to start from the innermost scope and continue outwards.
     // if we don't find the variable we assume it's global
-    std::for_each(m_scopes.rbegin(), m_scopes.rend(), [&](const auto &scope) -> void {
-        if (scope.contains(name.lexeme()))
+    for (auto scope = m_scopes.rbegin(); scope != m_scopes.rend(); scope++)
+    {
+        auto variable = scope->find(name.lexeme());
+        if (variable != scope->end())
         {
-            m_interpreter.lock()->resolve(expr, num_scopes);
+            m_interpreter.lock()->resolve(expr, num_scopes, variable->second.slot);
             return;
         }
         num_scopes++;
-    });
+    }
 }
 
 void Resolver::resolve_function(stmt::Function *function, FunctionType type)
@@ -309,6 +372,7 @@ void Resolver::resolve_function(stmt::Function *function, FunctionType type)
     }
 
     resolve(function->m_body);
+    function->m_slots = m_scopes.back().size();
 
     end_scope();
 
@@ -337,8 +401,10 @@ void Resolver::declare(const Token &name)
         error(name, "Variable with this name is already declared in this scope.");
     }
 
+    // variables get slots in the order they are declared,
+    // which is the order the interpreter defines them in
     bool is_ready = false;
-    scope.emplace(name.lexeme(), is_ready);
+    scope.emplace(name.lexeme(), LocalVariable{is_ready, static_cast<int>(scope.size())});
 }
 
 void Resolver::define(const Token &name)
@@ -348,7 +414,7 @@ void Resolver::define(const Token &name)
         return;
 
     bool is_ready = true;
-    m_scopes.back().at(name.lexeme()) = is_ready;
+    m_scopes.back().at(name.lexeme()).is_ready = is_ready;
 }
 
 void Resolver::import_module(const Token &name)
@@ -365,6 +431,13 @@ void Resolver::import_module(const Token &name)
         return;
     }
 
+    // native modules have no file - the interpreter defines their functions
+    if (m_interpreter.lock()->import_native_module(name.lexeme()))
+    {
+        m_imported_modules.push_back(name.lexeme());
+        return;
+    }
+
     std::string module_path;
     bool found_module = false;
     for (const std::string &path : m_search_paths)
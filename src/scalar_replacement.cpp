@@ -0,0 +1,796 @@
+#include "scalar_replacement.h"
+
+#include <algorithm>
+
+#include "fmt/core.h"
+
+namespace cpplox
+{
+namespace
+{
+// `name` with a suffix, at the position of `token`
+Token hidden(const Token& token, const std::string& name)
+{
+    return Token{TokenType::IDENTIFIER, name, std::nullopt, token.line(), token.str_line(), token.column()};
+}
+
+bool is_variable(const ExpressionPtr& expr, const std::string& name)
+{
+    auto variable = dynamic_cast<expr::Variable*>(expr.get());
+    return variable != nullptr && variable->m_name.lexeme() == name;
+}
+
+// Copies an expression, renaming the variables in `renames`.
+// Returns nullptr for expressions that can't be moved out of a method.
+ExpressionPtr clone(const ExpressionPtr& expr, const std::unordered_map<std::string, std::string>& renames)
+{
+    auto rename = [&](const Token& name) {
+        auto renamed = renames.find(name.lexeme());
+        return renamed == renames.end() ? name : hidden(name, renamed->second);
+    };
+    auto clone_all = [&](const std::vector<ExpressionPtr>& exprs, std::vector<ExpressionPtr>& clones) {
+        for (const auto& expr : exprs)
+        {
+            clones.push_back(clone(expr, renames));
+            if (clones.back() == nullptr)
+                return false;
+        }
+        return true;
+    };
+
+    if (auto literal = dynamic_cast<expr::Literal*>(expr.get()))
+        return std::make_shared<expr::Literal>(*literal->m_value);
+    if (auto variable = dynamic_cast<expr::Variable*>(expr.get()))
+        return std::make_shared<expr::Variable>(rename(variable->m_name));
+    if (auto assign = dynamic_cast<expr::Assign*>(expr.get()))
+    {
+        ExpressionPtr value = clone(assign->m_value, renames);
+        return value == nullptr ? nullptr : std::make_shared<expr::Assign>(rename(assign->m_name), value);
+    }
+    if (auto grouping = dynamic_cast<expr::Grouping*>(expr.get()))
+    {
+        ExpressionPtr inner = clone(grouping->m_expression, renames);
+        return inner == nullptr ? nullptr : std::make_shared<expr::Grouping>(inner);
+    }
+    if (auto unary = dynamic_cast<expr::Unary*>(expr.get()))
+    {
+        ExpressionPtr right = clone(unary->m_right, renames);
+        return right == nullptr ? nullptr : std::make_shared<expr::Unary>(unary->m_op, right);
+    }
+    if (auto binary = dynamic_cast<expr::Binary*>(expr.get()))
+    {
+        ExpressionPtr left = clone(binary->m_left, renames);
+        ExpressionPtr right = clone(binary->m_right, renames);
+        if (left == nullptr || right == nullptr)
+            return nullptr;
+        return std::make_shared<expr::Binary>(left, binary->m_op, right);
+    }
+    if (auto logical = dynamic_cast<expr::Logical*>(expr.get()))
+    {
+        ExpressionPtr left = clone(logical->m_left, renames);
+        ExpressionPtr right = clone(logical->m_right, renames);
+        if (left == nullptr || right == nullptr)
+            return nullptr;
+        return std::make_shared<expr::Logical>(left, logical->m_op, right);
+    }
+    if (auto call = dynamic_cast<expr::Call*>(expr.get()))
+    {
+        ExpressionPtr callee = clone(call->m_callee, renames);
+        std::vector<ExpressionPtr> args;
+        if (callee == nullptr || !clone_all(call->m_args, args))
+            return nullptr;
+        return std::make_shared<expr::Call>(callee, call->m_paren, args);
+    }
+    if (auto get = dynamic_cast<expr::Get*>(expr.get()))
+    {
+        ExpressionPtr object = clone(get->m_object, renames);
+        return object == nullptr ? nullptr : std::make_shared<expr::Get>(object, get->m_name);
+    }
+    if (auto invoke = dynamic_cast<expr::Invoke*>(expr.get()))
+    {
+        ExpressionPtr object = clone(invoke->m_object, renames);
+        std::vector<ExpressionPtr> args;
+        if (object == nullptr || !clone_all(invoke->m_args, args))
+            return nullptr;
+        return std::make_shared<expr::Invoke>(object, invoke->m_name, invoke->m_paren, args);
+    }
+
+    // `this`, `super`, lambdas and setters
+    return nullptr;
+}
+
+// Adds the names of all variables a cloneable expression reads or assigns to `names`
+void variable_names(const ExpressionPtr& expr, std::unordered_set<std::string>& names)
+{
+    if (auto variable = dynamic_cast<expr::Variable*>(expr.get()))
+        names.insert(variable->m_name.lexeme());
+    else if (auto assign = dynamic_cast<expr::Assign*>(expr.get()))
+    {
+        names.insert(assign->m_name.lexeme());
+        variable_names(assign->m_value, names);
+    }
+    else if (auto grouping = dynamic_cast<expr::Grouping*>(expr.get()))
+        variable_names(grouping->m_expression, names);
+    else if (auto unary = dynamic_cast<expr::Unary*>(expr.get()))
+        variable_names(unary->m_right, names);
+    else if (auto binary = dynamic_cast<expr::Binary*>(expr.get()))
+    {
+        variable_names(binary->m_left, names);
+        variable_names(binary->m_right, names);
+    }
+    else if (auto logical = dynamic_cast<expr::Logical*>(expr.get()))
+    {
+        variable_names(logical->m_left, names);
+        variable_names(logical->m_right, names);
+    }
+    else if (auto call = dynamic_cast<expr::Call*>(expr.get()))
+    {
+        variable_names(call->m_callee, names);
+        for (const auto& arg : call->m_args)
+        {
+            variable_names(arg, names);
+        }
+    }
+    else if (auto get = dynamic_cast<expr::Get*>(expr.get()))
+        variable_names(get->m_object, names);
+    else if (auto invoke = dynamic_cast<expr::Invoke*>(expr.get()))
+    {
+        variable_names(invoke->m_object, names);
+        for (const auto& arg : invoke->m_args)
+        {
+            variable_names(arg, names);
+        }
+    }
+}
+
+// Finds out whether a variable holding an instance is only used to get and set its fields,
+// and rewrites those uses to the variables the fields are kept in.
+// Uses inside nested functions count as escaping, because the closure could outlive the scope.
+class FieldUses
+{
+public:
+    FieldUses(std::string name, const std::unordered_set<std::string>& fields)
+        : m_name(std::move(name))
+        , m_fields(fields)
+    {
+    }
+
+    // Checks the statements from `from` on, which is where the variable is visible
+    bool only_fields(std::vector<StatementPtr>& stmts, size_t from)
+    {
+        m_rewrite = false;
+        m_escapes = false;
+        list(stmts, from);
+        return !m_escapes;
+    }
+
+    void rewrite(std::vector<StatementPtr>& stmts, size_t from)
+    {
+        m_rewrite = true;
+        list(stmts, from);
+    }
+
+private:
+    void list(std::vector<StatementPtr>& stmts, size_t from)
+    {
+        for (size_t i = from; i < stmts.size() && !m_escapes; i++)
+        {
+            stmt::Statement* stmt = stmts[i].get();
+
+            // a declaration of the same name hides the variable for the rest of the block
+            if (auto var = dynamic_cast<stmt::Var*>(stmt); var != nullptr && var->m_name.lexeme() == m_name)
+            {
+                if (var->m_initializer.has_value())
+                    expression(var->m_initializer.value());
+                return;
+            }
+            auto function = dynamic_cast<stmt::Function*>(stmt);
+            auto klass = dynamic_cast<stmt::Class*>(stmt);
+            if ((function != nullptr && function->m_name.lexeme() == m_name) ||
+                (klass != nullptr && klass->m_name.lexeme() == m_name))
+            {
+                m_escapes = true;
+                return;
+            }
+
+            statement(stmt);
+        }
+    }
+
+    void statement(stmt::Statement* stmt)
+    {
+        if (stmt == nullptr)
+            return;
+
+        if (auto expression_stmt = dynamic_cast<stmt::Expression*>(stmt))
+            expression(expression_stmt->m_expr);
+        else if (auto print = dynamic_cast<stmt::Print*>(stmt))
+            expression(print->m_expr);
+        else if (auto var = dynamic_cast<stmt::Var*>(stmt))
+        {
+            if (var->m_initializer.has_value())
+                expression(var->m_initializer.value());
+        }
+        else if (auto block = dynamic_cast<stmt::Block*>(stmt))
+            list(block->m_statements, 0);
+        else if (auto if_stmt = dynamic_cast<stmt::If*>(stmt))
+        {
+            expression(if_stmt->m_condition);
+            statement(if_stmt->m_then.get());
+            if (if_stmt->m_else.has_value())
+                statement(if_stmt->m_else->get());
+        }
+        else if (auto while_stmt = dynamic_cast<stmt::While*>(stmt))
+        {
+            expression(while_stmt->m_condition);
+            statement(while_stmt->m_stmt.get());
+        }
+        else if (auto function = dynamic_cast<stmt::Function*>(stmt))
+            nested(function->m_body);
+        else if (auto return_stmt = dynamic_cast<stmt::Return*>(stmt))
+        {
+            if (return_stmt->m_value.has_value())
+                expression(return_stmt->m_value.value());
+        }
+        else if (auto klass = dynamic_cast<stmt::Class*>(stmt))
+        {
+            if (klass->m_super.has_value() && klass->m_super.value()->m_name.lexeme() == m_name)
+                m_escapes = true;
+            for (const auto& method : klass->m_methods)
+            {
+                nested(method->m_body);
+            }
+        }
+    }
+
+    void expression(ExpressionPtr& expr)
+    {
+        if (expr == nullptr || m_escapes)
+            return;
+
+        if (auto variable = dynamic_cast<expr::Variable*>(expr.get()))
+        {
+            if (variable->m_name.lexeme() == m_name)
+                m_escapes = true;
+        }
+        else if (auto assign = dynamic_cast<expr::Assign*>(expr.get()))
+        {
+            if (assign->m_name.lexeme() == m_name)
+                m_escapes = true;
+            expression(assign->m_value);
+        }
+        else if (auto get = dynamic_cast<expr::Get*>(expr.get()))
+        {
+            if (!is_variable(get->m_object, m_name))
+                expression(get->m_object);
+            else if (!is_field(get->m_name))
+                m_escapes = true;
+            else if (m_rewrite)
+                expr = std::make_shared<expr::Variable>(hidden(get->m_name, m_name + "." + get->m_name.lexeme()));
+        }
+        else if (auto set = dynamic_cast<expr::Set*>(expr.get()))
+        {
+            if (!is_variable(set->m_object, m_name))
+            {
+                expression(set->m_object);
+                expression(set->m_value);
+            }
+            else if (!is_field(set->m_name))
+                m_escapes = true;
+            else
+            {
+                expression(set->m_value);
+                if (m_rewrite)
+                    expr = std::make_shared<expr::Assign>(hidden(set->m_name, m_name + "." + set->m_name.lexeme()),
+                                                          set->m_value);
+            }
+        }
+        else if (auto lambda = dynamic_cast<expr::Lambda*>(expr.get()))
+            nested(lambda->m_body);
+        else if (auto grouping = dynamic_cast<expr::Grouping*>(expr.get()))
+            expression(grouping->m_expression);
+        else if (auto unary = dynamic_cast<expr::Unary*>(expr.get()))
+            expression(unary->m_right);
+        else if (auto binary = dynamic_cast<expr::Binary*>(expr.get()))
+        {
+            expression(binary->m_left);
+            expression(binary->m_right);
+        }
+        else if (auto logical = dynamic_cast<expr::Logical*>(expr.get()))
+        {
+            expression(logical->m_left);
+            expression(logical->m_right);
+        }
+        else if (auto call = dynamic_cast<expr::Call*>(expr.get()))
+        {
+            expression(call->m_callee);
+            for (auto& arg : call->m_args)
+            {
+                expression(arg);
+            }
+        }
+        else if (auto invoke = dynamic_cast<expr::Invoke*>(expr.get()))
+        {
+            expression(invoke->m_object);
+            for (auto& arg : invoke->m_args)
+            {
+                expression(arg);
+            }
+        }
+        else if (auto array = dynamic_cast<expr::ArrayLiteral*>(expr.get()))
+        {
+            for (auto& element : array->m_elements)
+            {
+                expression(element);
+            }
+        }
+        else if (auto subscript = dynamic_cast<expr::Subscript*>(expr.get()))
+        {
+            expression(subscript->m_object);
+            expression(subscript->m_index);
+        }
+        else if (auto set_subscript = dynamic_cast<expr::SetSubscript*>(expr.get()))
+        {
+            expression(set_subscript->m_object);
+            expression(set_subscript->m_index);
+            expression(set_subscript->m_value);
+        }
+    }
+
+    // Checks a nested function body, where any use of the variable is an escape
+    void nested(std::vector<StatementPtr>& body)
+    {
+        m_nested++;
+        list(body, 0);
+        m_nested--;
+    }
+
+    [[nodiscard]] bool is_field(const Token& name) const
+    {
+        return m_nested == 0 && m_fields.contains(name.lexeme());
+    }
+
+    std::string m_name;
+    const std::unordered_set<std::string>& m_fields;
+    bool m_rewrite = false;
+    bool m_escapes = false;
+    int m_nested = 0;
+};
+
+}
+
+void ScalarReplacer::run(std::vector<StatementPtr>& stmts)
+{
+    // the first walk only learns which names are assigned and whether there are imports
+    m_collecting = true;
+    replace(stmts);
+    m_collecting = false;
+
+    if (m_has_imports)
+        return;
+
+    find_inlinable(stmts);
+    replace(stmts);
+}
+
+void ScalarReplacer::visit(stmt::Block* stmt)
+{
+    m_scopes.emplace_back();
+    replace(stmt->m_statements);
+    m_scopes.pop_back();
+}
+
+void ScalarReplacer::visit(stmt::Var* stmt)
+{
+    if (stmt->m_initializer.has_value())
+        visit(stmt->m_initializer.value());
+    declare(stmt->m_name.lexeme());
+}
+
+void ScalarReplacer::visit(stmt::Function* stmt)
+{
+    declare(stmt->m_name.lexeme());
+    visit_function(stmt->m_params, stmt->m_body);
+}
+
+void ScalarReplacer::visit(stmt::Expression* stmt)
+{
+    visit(stmt->m_expr);
+}
+
+void ScalarReplacer::visit(stmt::If* stmt)
+{
+    visit(stmt->m_condition);
+    stmt->m_then->accept(this);
+    if (stmt->m_else.has_value())
+        stmt->m_else.value()->accept(this);
+}
+
+void ScalarReplacer::visit(stmt::Print* stmt)
+{
+    visit(stmt->m_expr);
+}
+
+void ScalarReplacer::visit(stmt::Return* stmt)
+{
+    if (stmt->m_value.has_value())
+        visit(stmt->m_value.value());
+}
+
+void ScalarReplacer::visit(stmt::While* stmt)
+{
+    visit(stmt->m_condition);
+    stmt->m_stmt->accept(this);
+}
+
+void ScalarReplacer::visit(stmt::Class* stmt)
+{
+    declare(stmt->m_name.lexeme());
+
+    // methods see `this` and `super` as locals
+    m_scopes.push_back({"this", "super"});
+    for (const auto& method : stmt->m_methods)
+    {
+        visit_function(method->m_params, method->m_body);
+    }
+    m_scopes.pop_back();
+}
+
+void ScalarReplacer::visit(stmt::Import*)
+{
+    m_has_imports = true;
+}
+
+Value ScalarReplacer::visit(expr::Variable*)
+{
+    return std::nullopt;
+}
+
+Value ScalarReplacer::visit(expr::Assign* expr)
+{
+    m_assigned.insert(expr->m_name.lexeme());
+    visit(expr->m_value);
+    return std::nullopt;
+}
+
+Value ScalarReplacer::visit(expr::Lambda* expr)
+{
+    visit_function(expr->m_params, expr->m_body);
+    return std::nullopt;
+}
+
+Value ScalarReplacer::visit(expr::Binary* expr)
+{
+    visit(expr->m_left);
+    visit(expr->m_right);
+    return std::nullopt;
+}
+
+Value ScalarReplacer::visit(expr::Call* expr)
+{
+    visit(expr->m_callee);
+    for (const auto& arg : expr->m_args)
+    {
+        visit(arg);
+    }
+    return std::nullopt;
+}
+
+Value ScalarReplacer::visit(expr::Grouping* expr)
+{
+    visit(expr->m_expression);
+    return std::nullopt;
+}
+
+Value ScalarReplacer::visit(expr::Literal*)
+{
+    return std::nullopt;
+}
+
+Value ScalarReplacer::visit(expr::Logical* expr)
+{
+    visit(expr->m_left);
+    visit(expr->m_right);
+    return std::nullopt;
+}
+
+Value ScalarReplacer::visit(expr::Unary* expr)
+{
+    visit(expr->m_right);
+    return std::nullopt;
+}
+
+Value ScalarReplacer::visit(expr::Get* expr)
+{
+    visit(expr->m_object);
+    return std::nullopt;
+}
+
+Value ScalarReplacer::visit(expr::Set* expr)
+{
+    visit(expr->m_object);
+    visit(expr->m_value);
+    return std::nullopt;
+}
+
+Value ScalarReplacer::visit(expr::This*)
+{
+    return std::nullopt;
+}
+
+Value ScalarReplacer::visit(expr::Super*)
+{
+    return std::nullopt;
+}
+
+Value ScalarReplacer::visit(expr::Invoke* expr)
+{
+    visit(expr->m_object);
+    for (const auto& arg : expr->m_args)
+    {
+        visit(arg);
+    }
+    return std::nullopt;
+}
+
+Value ScalarReplacer::visit(expr::ArrayLiteral* expr)
+{
+    for (const auto& element : expr->m_elements)
+    {
+        visit(element);
+    }
+    return std::nullopt;
+}
+
+Value ScalarReplacer::visit(expr::Subscript* expr)
+{
+    visit(expr->m_object);
+    visit(expr->m_index);
+    return std::nullopt;
+}
+
+Value ScalarReplacer::visit(expr::SetSubscript* expr)
+{
+    visit(expr->m_object);
+    visit(expr->m_index);
+    visit(expr->m_value);
+    return std::nullopt;
+}
+
+Value ScalarReplacer::visit(expr::UpdateLocal*)
+{
+    return std::nullopt;
+}
+
+Value ScalarReplacer::visit(expr::CompareLocals*)
+{
+    return std::nullopt;
+}
+
+Value ScalarReplacer::visit(expr::UpdateField*)
+{
+    return std::nullopt;
+}
+
+void ScalarReplacer::print_stats()
+{
+    double rate = s_sites == 0 ? 0 : 100.0 * s_replaced / s_sites;
+    fmt::print(stderr, "instance allocation sites: {}\n", s_sites);
+    fmt::print(stderr, "scalar replaced:           {} ({:.1f}%)\n", s_replaced, rate);
+}
+
+void ScalarReplacer::find_inlinable(const std::vector<StatementPtr>& stmts)
+{
+    // a class is only known by its name if nothing else at the top level is declared with it
+    std::unordered_map<std::string, int> declarations;
+    for (const auto& stmt : stmts)
+    {
+        if (auto var = dynamic_cast<stmt::Var*>(stmt.get()))
+            declarations[var->m_name.lexeme()]++;
+        else if (auto function = dynamic_cast<stmt::Function*>(stmt.get()))
+            declarations[function->m_name.lexeme()]++;
+        else if (auto klass = dynamic_cast<stmt::Class*>(stmt.get()))
+        {
+            declarations[klass->m_name.lexeme()]++;
+            m_classes.insert(klass->m_name.lexeme());
+        }
+    }
+
+    for (const auto& stmt : stmts)
+    {
+        auto klass = dynamic_cast<stmt::Class*>(stmt.get());
+        if (klass == nullptr)
+            continue;
+
+        const std::string name = klass->m_name.lexeme();
+        if (declarations[name] != 1 || m_assigned.contains(name))
+            continue;
+
+        std::optional<Inlinable> initializer = inlinable(klass);
+        if (initializer.has_value())
+            m_inlinable.emplace(name, std::move(initializer.value()));
+    }
+}
+
+std::optional<ScalarReplacer::Inlinable> ScalarReplacer::inlinable(stmt::Class* klass)
+{
+    // a record's constructor takes the values of its fields
+    if (klass->m_fields.has_value())
+    {
+        Inlinable result;
+        for (const Token& field : klass->m_fields.value())
+        {
+            result.m_params.push_back(field.lexeme());
+            result.m_fields.emplace_back(field, std::make_shared<expr::Variable>(field));
+            result.m_field_names.insert(field.lexeme());
+        }
+        return result;
+    }
+
+    // an inherited `init` would have to be found in the superclass
+    if (klass->m_super.has_value())
+        return std::nullopt;
+
+    auto init = std::find_if(klass->m_methods.begin(), klass->m_methods.end(), [](const auto& method) {
+        return method->m_name.lexeme() == "init" &&
+               std::find(method->m_prefix.begin(), method->m_prefix.end(), "static") == method->m_prefix.end();
+    });
+    if (init == klass->m_methods.end())
+        return std::nullopt;
+
+    Inlinable result;
+    for (const Token& param : (*init)->m_params)
+    {
+        result.m_params.push_back(param.lexeme());
+    }
+
+    // only `this.name = value;` statements
+    for (const auto& stmt : (*init)->m_body)
+    {
+        auto expression_stmt = dynamic_cast<stmt::Expression*>(stmt.get());
+        auto set = expression_stmt != nullptr ? dynamic_cast<expr::Set*>(expression_stmt->m_expr.get()) : nullptr;
+        if (set == nullptr || dynamic_cast<expr::This*>(set->m_object.get()) == nullptr)
+            return std::nullopt;
+        if (clone(set->m_value, {}) == nullptr)
+            return std::nullopt;
+
+        variable_names(set->m_value, result.m_free_names);
+        result.m_fields.emplace_back(set->m_name, set->m_value);
+        result.m_field_names.insert(set->m_name.lexeme());
+    }
+
+    for (const std::string& param : result.m_params)
+    {
+        result.m_free_names.erase(param);
+    }
+
+    return result;
+}
+
+void ScalarReplacer::replace(std::vector<StatementPtr>& stmts)
+{
+    for (size_t i = 0; i < stmts.size(); i++)
+    {
+        // statements with parse errors are null
+        if (stmts[i] == nullptr)
+            continue;
+
+        if (!m_collecting)
+        {
+            std::vector<StatementPtr> replacement_stmts = replacement(stmts, i);
+            if (!replacement_stmts.empty())
+            {
+                stmts.erase(stmts.begin() + i);
+                stmts.insert(stmts.begin() + i, replacement_stmts.begin(), replacement_stmts.end());
+            }
+        }
+
+        stmts[i]->accept(this);
+    }
+}
+
+std::vector<StatementPtr> ScalarReplacer::replacement(std::vector<StatementPtr>& stmts, int index)
+{
+    // globals can be used by any function, so only locals are replaced
+    auto var = dynamic_cast<stmt::Var*>(stmts[index].get());
+    if (var == nullptr || m_scopes.empty() || !var->m_initializer.has_value())
+        return {};
+
+    auto call = dynamic_cast<expr::Call*>(var->m_initializer.value().get());
+    auto callee = call != nullptr ? dynamic_cast<expr::Variable*>(call->m_callee.get()) : nullptr;
+    if (callee == nullptr || is_local(callee->m_name.lexeme()) || !m_classes.contains(callee->m_name.lexeme()))
+        return {};
+
+    s_sites++;
+
+    auto found = m_inlinable.find(callee->m_name.lexeme());
+    if (found == m_inlinable.end())
+        return {};
+    const Inlinable& initializer = found->second;
+
+    // a wrong number of arguments is a runtime error, which the call reports
+    if (call->m_args.size() != initializer.m_params.size())
+        return {};
+    // the values of the fields must see the same variables as inside `init`
+    for (const std::string& name : initializer.m_free_names)
+    {
+        if (is_local(name))
+            return {};
+    }
+
+    // the resolver reports a variable used in its own initializer, which it can't once it's replaced
+    const std::string name = var->m_name.lexeme();
+    std::vector<StatementPtr> args;
+    for (const auto& arg : call->m_args)
+    {
+        args.push_back(std::make_shared<stmt::Expression>(arg));
+    }
+    const std::unordered_set<std::string> no_fields;
+    if (!FieldUses{name, no_fields}.only_fields(args, 0))
+        return {};
+
+    FieldUses uses{name, initializer.m_field_names};
+    if (!uses.only_fields(stmts, index + 1))
+        return {};
+    uses.rewrite(stmts, index + 1);
+
+    std::vector<StatementPtr> result;
+    // looking the class up still reports it if it isn't defined yet
+    result.push_back(std::make_shared<stmt::Expression>(call->m_callee));
+
+    std::unordered_map<std::string, std::string> renames;
+    for (size_t i = 0; i < initializer.m_params.size(); i++)
+    {
+        const std::string& param = initializer.m_params[i];
+        renames.emplace(param, name + "#" + param);
+        result.push_back(
+            std::make_shared<stmt::Var>(hidden(var->m_name, name + "#" + param), std::make_optional(call->m_args[i])));
+    }
+
+    std::unordered_set<std::string> defined;
+    for (const auto& [field, value] : initializer.m_fields)
+    {
+        Token variable = hidden(field, name + "." + field.lexeme());
+        ExpressionPtr field_value = clone(value, renames);
+        // assigning a field twice in `init` assigns the variable
+        if (defined.insert(field.lexeme()).second)
+            result.push_back(std::make_shared<stmt::Var>(variable, std::make_optional(field_value)));
+        else
+            result.push_back(
+                std::make_shared<stmt::Expression>(std::make_shared<expr::Assign>(variable, field_value)));
+    }
+
+    s_replaced++;
+    return result;
+}
+
+bool ScalarReplacer::is_local(const std::string& name) const
+{
+    return std::any_of(m_scopes.begin(), m_scopes.end(),
+                       [&](const std::unordered_set<std::string>& scope) { return scope.contains(name); });
+}
+
+void ScalarReplacer::declare(const std::string& name)
+{
+    if (!m_scopes.empty())
+        m_scopes.back().insert(name);
+}
+
+void ScalarReplacer::visit(const ExpressionPtr& expr)
+{
+    if (expr != nullptr)
+        expr->accept(this);
+}
+
+void ScalarReplacer::visit_function(const std::vector<Token>& params, std::vector<StatementPtr>& body)
+{
+    m_scopes.emplace_back();
+    for (const Token& param : params)
+    {
+        declare(param.lexeme());
+    }
+    replace(body);
+    m_scopes.pop_back();
+}
+
+}
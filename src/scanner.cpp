@@ -82,6 +82,12 @@ void Scanner::scan_token()
         case '}':
             add_token(TokenType::RIGHT_BRACE);
             break;
+        case '[':
+            add_token(TokenType::LEFT_BRACKET);
+            break;
+        case ']':
+            add_token(TokenType::RIGHT_BRACKET);
+            break;
         case ',':
             add_token(TokenType::COMMA);
             break;
@@ -171,8 +177,9 @@ void Scanner::string()
     advance();
 
     // get the lexeme
-    std::string value = m_source.substr(m_start + 1, m_current - m_start - 2);
-    add_token(TokenType::STRING, value);
+    // equal literals share one string object
+    std::string_view value = std::string_view{m_source}.substr(m_start + 1, m_current - m_start - 2);
+    add_token(TokenType::STRING, String::intern(value));
 }
 
 void Scanner::number()
@@ -316,7 +323,8 @@ std::optional<TokenType> Scanner::str_to_keyword(const std::string& str)
         {"if", TokenType::IF},       {"nil", TokenType::NIL},       {"or", TokenType::OR},
         {"print", TokenType::PRINT}, {"return", TokenType::RETURN}, {"super", TokenType::SUPER},
         {"this", TokenType::THIS},   {"true", TokenType::TRUE},     {"var", TokenType::VAR},
-        {"while", TokenType::WHILE}, {"static", TokenType::PREFIX}, {"import", TokenType::IMPORT}};
+        {"while", TokenType::WHILE}, {"static", TokenType::PREFIX}, {"import", TokenType::IMPORT},
+        {"record", TokenType::RECORD}};
 
     if (keyword_lookup.contains(str))
     {
@@ -0,0 +1,28 @@
+#include "shape.h"
+
+namespace cpplox
+{
+int Shape::lookup(const std::string& name) const
+{
+    auto slot = m_slots.find(name);
+    if (slot == m_slots.end())
+        return -1;
+
+    return slot->second;
+}
+
+std::shared_ptr<Shape> Shape::with_field(const std::string& name)
+{
+    auto transition = m_transitions.find(name);
+    if (transition != m_transitions.end())
+        return transition->second;
+
+    auto shape = std::make_shared<Shape>();
+    shape->m_slots = m_slots;
+    shape->m_slots.emplace(name, size());
+    m_transitions.emplace(name, shape);
+
+    return shape;
+}
+
+}
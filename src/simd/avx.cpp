@@ -0,0 +1,118 @@
+#if defined(__x86_64__)
+
+#include <immintrin.h>
+
+#include "simd/vector_kernels.h"
+
+// This file is compiled with -mavx. Its kernels only run after `kernels()` has checked the CPU has AVX.
+namespace cpplox::simd
+{
+namespace
+{
+// Four doubles at a time
+struct Avx
+{
+    using Vec = __m256d;
+    static constexpr std::size_t WIDTH = 4;
+
+    static inline Vec load(const double* ptr)
+    {
+        return _mm256_loadu_pd(ptr);
+    }
+    static inline Vec load_one(const double* ptr)
+    {
+        return _mm256_set_pd(0, 0, 0, *ptr);
+    }
+    static inline void store(double* ptr, Vec x)
+    {
+        _mm256_storeu_pd(ptr, x);
+    }
+    static inline void store_one(double* ptr, Vec x)
+    {
+        _mm_store_sd(ptr, _mm256_castpd256_pd128(x));
+    }
+    static inline Vec broadcast(double value)
+    {
+        return _mm256_set1_pd(value);
+    }
+    static inline Vec zero()
+    {
+        return _mm256_setzero_pd();
+    }
+    static inline double to_double(Vec x)
+    {
+        return _mm256_cvtsd_f64(x);
+    }
+
+    static inline Vec add(Vec x, Vec y)
+    {
+        return _mm256_add_pd(x, y);
+    }
+    static inline Vec sub(Vec x, Vec y)
+    {
+        return _mm256_sub_pd(x, y);
+    }
+    static inline Vec mul(Vec x, Vec y)
+    {
+        return _mm256_mul_pd(x, y);
+    }
+    // vminpd and vmaxpd return the second operand when either is NaN or both are equal
+    static inline Vec min(Vec x, Vec acc)
+    {
+        return _mm256_min_pd(x, acc);
+    }
+    static inline Vec max(Vec x, Vec acc)
+    {
+        return _mm256_max_pd(x, acc);
+    }
+    static inline Vec less(Vec x, Vec y)
+    {
+        return _mm256_and_pd(_mm256_cmp_pd(x, y, _CMP_LT_OQ), _mm256_set1_pd(1));
+    }
+    static inline Vec greater(Vec x, Vec y)
+    {
+        return _mm256_and_pd(_mm256_cmp_pd(x, y, _CMP_GT_OQ), _mm256_set1_pd(1));
+    }
+
+    static inline Vec nan_mask(Vec x)
+    {
+        return _mm256_cmp_pd(x, x, _CMP_UNORD_Q);
+    }
+    static inline Vec either(Vec x, Vec y)
+    {
+        return _mm256_or_pd(x, y);
+    }
+    static inline bool any(Vec mask)
+    {
+        return _mm256_movemask_pd(mask) != 0;
+    }
+
+    // Moves every element `count` lanes up and fills the lanes below with 0
+    static inline Vec shift_up(Vec x, int count)
+    {
+        // [0, 0, x0, x1]
+        Vec low_to_high = _mm256_permute2f128_pd(x, x, 0x08);
+        if (count == 2)
+            return low_to_high;
+
+        // [0, x0, x1, x2]
+        return _mm256_shuffle_pd(low_to_high, x, 0b0101);
+    }
+    // The last element in every lane
+    static inline Vec last(Vec x)
+    {
+        Vec high = _mm256_permute2f128_pd(x, x, 0x11);
+        return _mm256_permute_pd(high, 0b1111);
+    }
+};
+
+}
+
+const Kernels& avx_kernels()
+{
+    return VectorKernels<Avx>::get("avx");
+}
+
+}
+
+#endif
@@ -0,0 +1,20 @@
+#include "simd/kernels.h"
+
+namespace cpplox::simd
+{
+const Kernels& kernels()
+{
+    static const Kernels& best = []() -> const Kernels& {
+#if defined(__x86_64__)
+        if (__builtin_cpu_supports("avx"))
+            return avx_kernels();
+        return sse2_kernels();
+#else
+        return portable_kernels();
+#endif
+    }();
+
+    return best;
+}
+
+}
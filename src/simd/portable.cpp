@@ -0,0 +1,94 @@
+#include "simd/vector_kernels.h"
+
+#include <cmath>
+
+namespace cpplox::simd
+{
+namespace
+{
+// One double at a time, for CPUs without vector instructions the kernels know
+struct Portable
+{
+    using Vec = double;
+    static constexpr std::size_t WIDTH = 1;
+
+    static inline Vec load(const double* ptr)
+    {
+        return *ptr;
+    }
+    static inline Vec load_one(const double* ptr)
+    {
+        return *ptr;
+    }
+    static inline void store(double* ptr, Vec x)
+    {
+        *ptr = x;
+    }
+    static inline void store_one(double* ptr, Vec x)
+    {
+        *ptr = x;
+    }
+    static inline Vec broadcast(double value)
+    {
+        return value;
+    }
+    static inline Vec zero()
+    {
+        return 0;
+    }
+    static inline double to_double(Vec x)
+    {
+        return x;
+    }
+
+    static inline Vec add(Vec x, Vec y)
+    {
+        return x + y;
+    }
+    static inline Vec sub(Vec x, Vec y)
+    {
+        return x - y;
+    }
+    static inline Vec mul(Vec x, Vec y)
+    {
+        return x * y;
+    }
+    static inline Vec min(Vec x, Vec acc)
+    {
+        return x < acc ? x : acc;
+    }
+    static inline Vec max(Vec x, Vec acc)
+    {
+        return x > acc ? x : acc;
+    }
+    static inline Vec less(Vec x, Vec y)
+    {
+        return x < y ? 1 : 0;
+    }
+    static inline Vec greater(Vec x, Vec y)
+    {
+        return x > y ? 1 : 0;
+    }
+
+    static inline Vec nan_mask(Vec x)
+    {
+        return std::isnan(x) ? 1 : 0;
+    }
+    static inline Vec either(Vec x, Vec y)
+    {
+        return x != 0 || y != 0 ? 1 : 0;
+    }
+    static inline bool any(Vec mask)
+    {
+        return mask != 0;
+    }
+};
+
+}
+
+const Kernels& portable_kernels()
+{
+    return VectorKernels<Portable>::get("portable");
+}
+
+}
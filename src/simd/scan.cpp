@@ -0,0 +1,102 @@
+#include "simd/scan.h"
+
+#if defined(__x86_64__)
+#include <emmintrin.h>
+#endif
+
+namespace cpplox::simd
+{
+const char* find_either(const char* begin, const char* end, char first, char second)
+{
+    const char* cursor = begin;
+#if defined(__x86_64__)
+    __m128i firsts = _mm_set1_epi8(first);
+    __m128i seconds = _mm_set1_epi8(second);
+    for (; cursor + 16 <= end; cursor += 16)
+    {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cursor));
+        __m128i found = _mm_or_si128(_mm_cmpeq_epi8(bytes, firsts), _mm_cmpeq_epi8(bytes, seconds));
+        // one bit per byte
+        int mask = _mm_movemask_epi8(found);
+        if (mask != 0)
+            return cursor + __builtin_ctz(mask);
+    }
+#endif
+    for (; cursor < end; cursor++)
+    {
+        if (*cursor == first || *cursor == second)
+            return cursor;
+    }
+
+    return end;
+}
+
+std::size_t count(const char* begin, const char* end, char byte)
+{
+    std::size_t total = 0;
+    const char* cursor = begin;
+#if defined(__x86_64__)
+    __m128i bytes_to_find = _mm_set1_epi8(byte);
+    for (; cursor + 16 <= end; cursor += 16)
+    {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cursor));
+        total += __builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, bytes_to_find)));
+    }
+#endif
+    for (; cursor < end; cursor++)
+    {
+        total += *cursor == byte;
+    }
+
+    return total;
+}
+
+std::uint64_t block_mask(const char* block, std::string_view bytes)
+{
+    std::uint64_t mask = 0;
+#if defined(__x86_64__)
+    for (std::size_t lane = 0; lane < BLOCK_SIZE; lane += 16)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + lane));
+        __m128i found = _mm_setzero_si128();
+        for (char byte : bytes)
+        {
+            found = _mm_or_si128(found, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(byte)));
+        }
+        mask |= static_cast<std::uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(found))) << lane;
+    }
+#else
+    for (std::size_t i = 0; i < BLOCK_SIZE; i++)
+    {
+        if (bytes.find(block[i]) != std::string_view::npos)
+            mask |= std::uint64_t{1} << i;
+    }
+#endif
+
+    return mask;
+}
+
+std::uint64_t block_controls(const char* block)
+{
+    std::uint64_t mask = 0;
+#if defined(__x86_64__)
+    __m128i highest = _mm_set1_epi8(0x1f);
+    for (std::size_t lane = 0; lane < BLOCK_SIZE; lane += 16)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + lane));
+        // SSE2 only compares signed bytes, but min(x, 0x1f) == x exactly for the unsigned bytes up to 0x1f
+        __m128i found = _mm_cmpeq_epi8(_mm_min_epu8(chunk, highest), chunk);
+        mask |= static_cast<std::uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(found))) << lane;
+    }
+#else
+    for (std::size_t i = 0; i < BLOCK_SIZE; i++)
+    {
+        if (static_cast<unsigned char>(block[i]) < 0x20)
+            mask |= std::uint64_t{1} << i;
+    }
+#endif
+
+    return mask;
+}
+
+}
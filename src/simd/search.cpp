@@ -0,0 +1,89 @@
+#include "simd/search.h"
+
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <emmintrin.h>
+
+#include "simd/block_search.h"
+#endif
+
+namespace cpplox::simd
+{
+namespace
+{
+using Search = std::size_t (*)(std::string_view text, std::string_view pattern, std::size_t from);
+
+#if defined(__x86_64__)
+// 16 bytes at a time. Every x86-64 CPU has SSE2.
+struct Sse2
+{
+    using Block = __m128i;
+    static constexpr std::size_t WIDTH = 16;
+
+    static inline Block load(const char* ptr)
+    {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+    }
+    static inline Block broadcast(char byte)
+    {
+        return _mm_set1_epi8(byte);
+    }
+    static inline std::uint32_t equal(Block x, Block y)
+    {
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)));
+    }
+};
+#endif
+
+}
+
+std::size_t find(std::string_view text, std::string_view pattern, std::size_t from)
+{
+    static const Search best = []() -> Search {
+#if defined(__x86_64__)
+        if (__builtin_cpu_supports("avx2"))
+            return avx2_find;
+        return sse2_find;
+#else
+        return portable_find;
+#endif
+    }();
+
+    if (pattern.empty())
+        return from;
+    if (from > text.size() || pattern.size() > text.size() - from)
+        return std::string_view::npos;
+
+    return best(text, pattern, from);
+}
+
+// memchr, which libc vectorizes, skips to the places where the first byte matches,
+// and only those are compared in full
+std::size_t portable_find(std::string_view text, std::string_view pattern, std::size_t from)
+{
+    const char* begin = text.data();
+    // one past the last position a match can start at
+    const char* limit = begin + text.size() - pattern.size() + 1;
+    const char* cursor = begin + from;
+    while (cursor < limit)
+    {
+        cursor = static_cast<const char*>(std::memchr(cursor, pattern[0], limit - cursor));
+        if (cursor == nullptr)
+            break;
+        if (std::memcmp(cursor + 1, pattern.data() + 1, pattern.size() - 1) == 0)
+            return cursor - begin;
+        cursor++;
+    }
+
+    return std::string_view::npos;
+}
+
+#if defined(__x86_64__)
+std::size_t sse2_find(std::string_view text, std::string_view pattern, std::size_t from)
+{
+    return BlockSearch<Sse2>::find(text, pattern, from);
+}
+#endif
+
+}
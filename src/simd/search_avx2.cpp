@@ -0,0 +1,41 @@
+#if defined(__x86_64__)
+
+#include <immintrin.h>
+
+#include "simd/block_search.h"
+
+// This file is compiled with -mavx2. Its search only runs after `find()` has checked the CPU has AVX2.
+namespace cpplox::simd
+{
+namespace
+{
+// 32 bytes at a time. Comparing bytes in 256-bit registers needs AVX2, AVX alone only has it for floats.
+struct Avx2
+{
+    using Block = __m256i;
+    static constexpr std::size_t WIDTH = 32;
+
+    static inline Block load(const char* ptr)
+    {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+    }
+    static inline Block broadcast(char byte)
+    {
+        return _mm256_set1_epi8(byte);
+    }
+    static inline std::uint32_t equal(Block x, Block y)
+    {
+        return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)));
+    }
+};
+
+}
+
+std::size_t avx2_find(std::string_view text, std::string_view pattern, std::size_t from)
+{
+    return BlockSearch<Avx2>::find(text, pattern, from);
+}
+
+}
+
+#endif
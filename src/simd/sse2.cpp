@@ -0,0 +1,99 @@
+#if defined(__x86_64__)
+
+#include <emmintrin.h>
+
+#include "simd/vector_kernels.h"
+
+namespace cpplox::simd
+{
+namespace
+{
+// Two doubles at a time. Every x86-64 CPU has SSE2.
+struct Sse2
+{
+    using Vec = __m128d;
+    static constexpr std::size_t WIDTH = 2;
+
+    static inline Vec load(const double* ptr)
+    {
+        return _mm_loadu_pd(ptr);
+    }
+    static inline Vec load_one(const double* ptr)
+    {
+        return _mm_load_sd(ptr);
+    }
+    static inline void store(double* ptr, Vec x)
+    {
+        _mm_storeu_pd(ptr, x);
+    }
+    static inline void store_one(double* ptr, Vec x)
+    {
+        _mm_store_sd(ptr, x);
+    }
+    static inline Vec broadcast(double value)
+    {
+        return _mm_set1_pd(value);
+    }
+    static inline Vec zero()
+    {
+        return _mm_setzero_pd();
+    }
+    static inline double to_double(Vec x)
+    {
+        return _mm_cvtsd_f64(x);
+    }
+
+    static inline Vec add(Vec x, Vec y)
+    {
+        return _mm_add_pd(x, y);
+    }
+    static inline Vec sub(Vec x, Vec y)
+    {
+        return _mm_sub_pd(x, y);
+    }
+    static inline Vec mul(Vec x, Vec y)
+    {
+        return _mm_mul_pd(x, y);
+    }
+    // minpd and maxpd return the second operand when either is NaN or both are equal
+    static inline Vec min(Vec x, Vec acc)
+    {
+        return _mm_min_pd(x, acc);
+    }
+    static inline Vec max(Vec x, Vec acc)
+    {
+        return _mm_max_pd(x, acc);
+    }
+    static inline Vec less(Vec x, Vec y)
+    {
+        return _mm_and_pd(_mm_cmplt_pd(x, y), _mm_set1_pd(1));
+    }
+    static inline Vec greater(Vec x, Vec y)
+    {
+        return _mm_and_pd(_mm_cmpgt_pd(x, y), _mm_set1_pd(1));
+    }
+
+    static inline Vec nan_mask(Vec x)
+    {
+        return _mm_cmpunord_pd(x, x);
+    }
+    static inline Vec either(Vec x, Vec y)
+    {
+        return _mm_or_pd(x, y);
+    }
+    static inline bool any(Vec mask)
+    {
+        return _mm_movemask_pd(mask) != 0;
+    }
+};
+
+}
+
+const Kernels& sse2_kernels()
+{
+    return VectorKernels<Sse2>::get("sse2");
+}
+
+}
+
+#endif
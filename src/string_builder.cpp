@@ -0,0 +1,83 @@
+#include "string_builder.h"
+
+#include <charconv>
+#include <cmath>
+
+#include "frame_pool.h"
+
+namespace cpplox
+{
+std::shared_ptr<StringBuilder> StringBuilder::create()
+{
+    return std::allocate_shared<StringBuilder>(FrameAllocator<StringBuilder>{});
+}
+
+void StringBuilder::append(const Value& value)
+{
+    // `storage` is only filled for values that aren't strings or numbers
+    NumberBuffer buffer;
+    std::string storage;
+    m_text += value.text(buffer, storage);
+}
+
+void StringBuilder::append_number(double number, int digits)
+{
+    // numbers this large are written like `print` writes them, instead of with hundreds of digits
+    if (!std::isfinite(number) || std::abs(number) >= 1e21)
+    {
+        NumberBuffer buffer;
+        m_text += format_number(number, buffer);
+        return;
+    }
+
+    // a sign, 21 digits, the point and the digits after it
+    char buffer[24 + MAX_DIGITS];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), number, std::chars_format::fixed, digits);
+    m_text.append(buffer, result.ptr);
+}
+
+int StringBuilder::method_arity(std::string_view name)
+{
+    if (name == "append")
+        return 1;
+    if (name == "append_number")
+        return 2;
+    if (name == "clear" || name == "build")
+        return 0;
+
+    return -1;
+}
+
+Value StringBuilder::call_method(const Token& name, const Token& paren, const std::vector<Value>& args)
+{
+    const std::string& method = name.lexeme();
+    if (method == "build")
+        return String::create(m_text);
+
+    if (method == "append")
+    {
+        append(args[0]);
+    }
+    else if (method == "append_number")
+    {
+        if (!args[0].m_value.has_value() || !std::holds_alternative<double>(args[0].m_value.value()))
+            throw RuntimeError{paren, "The number to append must be a number."};
+        if (!args[1].m_value.has_value() || !std::holds_alternative<double>(args[1].m_value.value()))
+            throw RuntimeError{paren, "The count of digits must be a number."};
+
+        double digits = std::get<double>(args[1].m_value.value());
+        if (digits != std::floor(digits) || digits < 0 || digits > MAX_DIGITS)
+            throw RuntimeError{paren, "The count of digits must be an integer from 0 to " +
+                                          std::to_string(MAX_DIGITS) + "."};
+
+        append_number(std::get<double>(args[0].m_value.value()), static_cast<int>(digits));
+    }
+    else
+    {
+        m_text.clear();
+    }
+
+    return shared_from_this();
+}
+
+}
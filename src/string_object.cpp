@@ -0,0 +1,186 @@
+#include "string_object.h"
+
+#include <unordered_map>
+#include <vector>
+
+#include "frame_pool.h"
+
+namespace cpplox
+{
+namespace
+{
+// A buffer that owns `text`
+std::shared_ptr<const char> own(std::string text)
+{
+    auto owner = std::make_shared<const std::string>(std::move(text));
+    return {owner, owner->data()};
+}
+
+}
+
+String::String(std::string text)
+    : m_length(text.size())
+{
+    m_buffer = own(std::move(text));
+}
+
+String::String(std::shared_ptr<String> left, std::shared_ptr<String> right)
+    : m_length(left->length() + right->length())
+    , m_left(std::move(left))
+    , m_right(std::move(right))
+{
+}
+
+String::String(std::shared_ptr<const char> buffer, std::size_t offset, std::size_t length)
+    : m_buffer(std::move(buffer))
+    , m_offset(offset)
+    , m_length(length)
+{
+}
+
+String::~String()
+{
+    release(std::move(m_left));
+    release(std::move(m_right));
+}
+
+std::shared_ptr<String> String::create(std::string text)
+{
+    return std::allocate_shared<String>(FrameAllocator<String>{}, std::move(text));
+}
+
+std::shared_ptr<String> String::intern(std::string_view text)
+{
+    // keys point into the interned strings' own buffers
+    static std::unordered_map<std::string_view, std::shared_ptr<String>> interned;
+
+    auto str = interned.find(text);
+    if (str != interned.end())
+        return str->second;
+
+    auto created = create(std::string{text});
+    interned.emplace(created->view(), created);
+    return created;
+}
+
+std::shared_ptr<String> String::concat(const std::shared_ptr<String>& left, const std::shared_ptr<String>& right)
+{
+    if (left->length() == 0)
+        return right;
+    if (right->length() == 0)
+        return left;
+
+    // a rope node costs more than copying a few characters
+    if (left->length() + right->length() < MIN_ROPE_LENGTH)
+    {
+        std::string text;
+        text.reserve(left->length() + right->length());
+        text.append(left->view());
+        text.append(right->view());
+        return create(std::move(text));
+    }
+
+    return std::allocate_shared<String>(FrameAllocator<String>{}, left, right);
+}
+
+std::shared_ptr<String> String::slice(const std::shared_ptr<String>& str, std::size_t start, std::size_t length)
+{
+    if (start == 0 && length == str->length())
+        return str;
+
+    if (str->is_rope())
+        str->flatten();
+    return std::allocate_shared<String>(FrameAllocator<String>{}, str->m_buffer, str->m_offset + start, length);
+}
+
+std::shared_ptr<String> String::borrow(std::shared_ptr<const char> buffer, std::size_t start, std::size_t length)
+{
+    return std::allocate_shared<String>(FrameAllocator<String>{}, std::move(buffer), start, length);
+}
+
+std::string_view String::view() const
+{
+    if (is_rope())
+        flatten();
+
+    return std::string_view{m_buffer.get() + m_offset, m_length};
+}
+
+std::size_t String::hash() const
+{
+    if (!m_has_hash)
+    {
+        m_hash = std::hash<std::string_view>{}(view());
+        m_has_hash = true;
+    }
+
+    return m_hash;
+}
+
+bool String::equals(const String& other) const
+{
+    if (this == &other)
+        return true;
+    if (m_length != other.m_length)
+        return false;
+    if (m_has_hash && other.m_has_hash && m_hash != other.m_hash)
+        return false;
+
+    return view() == other.view();
+}
+
+void String::flatten() const
+{
+    std::string text;
+    text.reserve(m_length);
+
+    // Concatenating in a loop makes a rope as deep as the loop is long,
+    // so it's walked with an explicit stack instead of recursion
+    std::vector<const String*> stack{this};
+    while (!stack.empty())
+    {
+        const String* node = stack.back();
+        stack.pop_back();
+
+        if (!node->is_rope())
+        {
+            text.append(node->m_buffer.get() + node->m_offset, node->m_length);
+            continue;
+        }
+
+        stack.push_back(node->m_right.get());
+        stack.push_back(node->m_left.get());
+    }
+
+    m_buffer = own(std::move(text));
+    m_offset = 0;
+    release(std::move(m_left));
+    release(std::move(m_right));
+}
+
+void String::release(std::shared_ptr<String> node)
+{
+    // nodes that survive or have no children are simply dropped
+    if (node == nullptr || node.use_count() > 1 || node->m_left == nullptr)
+        return;
+
+    // Destroying the last reference to a deep rope would recurse once per node.
+    // Children of nodes that are about to die are moved out first, so every node dies childless.
+    std::vector<std::shared_ptr<String>> pending;
+    pending.push_back(std::move(node));
+    while (!pending.empty())
+    {
+        std::shared_ptr<String> current = std::move(pending.back());
+        pending.pop_back();
+
+        if (current == nullptr || current.use_count() > 1)
+            continue;
+
+        if (current->m_left != nullptr)
+            pending.push_back(std::move(current->m_left));
+        if (current->m_right != nullptr)
+            pending.push_back(std::move(current->m_right));
+    }
+}
+
+}
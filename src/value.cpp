@@ -1,29 +1,93 @@
 #include "value.h"
 
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+
+#include "array.h"
 #include "error.h"
+#include "float64_array.h"
 #include "instance.h"
+#include "json.h"
+#include "map.h"
+#include "record_array.h"
+#include "string_builder.h"
 
 namespace cpplox
 {
+namespace
+{
+// Reads a decimal like `-12.75` with at most 15 digits. Such a number is an integer below 2^53 divided by
+// a power of ten, both exact as doubles, so one division rounds it correctly. Returns false for anything else.
+bool parse_short_decimal(std::string_view text, double& number)
+{
+    static constexpr double POWERS_OF_TEN[] = {1e0, 1e1, 1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                               1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+
+    std::size_t i = text[0] == '-' ? 1 : 0;
+    std::uint64_t mantissa = 0;
+    std::size_t digits = 0;
+    std::size_t decimals = 0;
+    bool point = false;
+    for (; i < text.size(); i++)
+    {
+        char c = text[i];
+        if (c >= '0' && c <= '9')
+        {
+            mantissa = mantissa * 10 + (c - '0');
+            digits++;
+            decimals += point;
+        }
+        else if (c == '.' && !point)
+        {
+            point = true;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    if (digits == 0 || digits > 15)
+        return false;
+
+    number = static_cast<double>(mantissa) / POWERS_OF_TEN[decimals];
+    if (text[0] == '-')
+        number = -number;
+    return true;
+}
+
+
+}
+
 std::ostream& operator<<(std::ostream& stream, const Value& val)
 {
-    return stream << val.to_string();
+    NumberBuffer buffer;
+    std::string storage;
+    return stream << val.text(buffer, storage);
 }
 
 std::string Value::to_string() const
+{
+    NumberBuffer buffer;
+    std::string storage;
+    std::string_view text = this->text(buffer, storage);
+    // other values are already in `storage`
+    if (text.data() == storage.data())
+        return storage;
+
+    return std::string{text};
+}
+
+std::string_view Value::text(NumberBuffer& buffer, std::string& storage) const
 {
     if (!m_value.has_value()) return "nil";
 
     switch (m_value->index())
     {
         case 0:
-            return std::get<std::string>(m_value.value());
+            return std::get<std::shared_ptr<String>>(m_value.value())->view();
         case 1:
-        {
-            std::string text = std::to_string(std::get<double>(m_value.value()));
-            text = trim_zeroes(text);
-            return text;
-        }
+            return format_number(std::get<double>(m_value.value()), buffer);
         case 2:
         {
             bool boolean = std::get<bool>(m_value.value());
@@ -32,12 +96,38 @@ std::string Value::to_string() const
         }
         case 3:
         {
-            return std::get<std::shared_ptr<Callable>>(m_value.value())->to_string();
+            storage = std::get<std::shared_ptr<Callable>>(m_value.value())->to_string();
+            return storage;
         }
         case 4:
         {
-            return std::get<std::shared_ptr<Instance>>(m_value.value())->to_string();
+            storage = std::get<std::shared_ptr<Instance>>(m_value.value())->to_string();
+            return storage;
         }
+        case 5:
+        {
+            storage = std::get<std::shared_ptr<Array>>(m_value.value())->to_string();
+            return storage;
+        }
+        case 6:
+        {
+            storage = std::get<std::shared_ptr<Map>>(m_value.value())->to_string();
+            return storage;
+        }
+        case 7:
+        {
+            storage = std::get<std::shared_ptr<Float64Array>>(m_value.value())->to_string();
+            return storage;
+        }
+        case 8:
+        {
+            storage = std::get<std::shared_ptr<RecordArray>>(m_value.value())->to_string();
+            return storage;
+        }
+        case 9:
+            return std::get<std::shared_ptr<LazyJson>>(m_value.value())->text();
+        case 10:
+            return std::get<std::shared_ptr<StringBuilder>>(m_value.value())->text();
         case std::variant_npos:
             return "nil";
         default:
@@ -46,14 +136,30 @@ std::string Value::to_string() const
     }
 }
 
-std::string trim_zeroes(const std::string& str)
+std::string_view format_number(double number, NumberBuffer& buffer)
 {
-    if (str.ends_with(".000000"))
-    {
-        return str.substr(0, str.size() - 7);
-    }
+    // fixed notation is used where it's still readable, like JavaScript does.
+    // Both notations give the shortest digits that read back as the same number
+    double magnitude = std::abs(number);
+    std::to_chars_result result;
+    if (magnitude == 0 || (magnitude >= 1e-7 && magnitude < 1e21))
+        result = std::to_chars(buffer.begin(), buffer.end(), number, std::chars_format::fixed);
+    else
+        result = std::to_chars(buffer.begin(), buffer.end(), number);
+
+    return {buffer.data(), static_cast<std::size_t>(result.ptr - buffer.data())};
+}
+
+bool parse_number(std::string_view text, double& number)
+{
+    if (text.empty())
+        return false;
+    if (parse_short_decimal(text, number))
+        return true;
 
-    return str;
+    const char* end = text.data() + text.size();
+    auto [stop, error] = std::from_chars(text.data(), end, number);
+    return error == std::errc{} && stop == end;
 }
 
 }